@@ -84,10 +84,57 @@ namespace
     int  checkpoint_nfiles;
     int  regrid_on_restart;
     int  use_efficient_regrid;
+    int  incremental_regrid;
     int  plotfile_on_restart;
     int  checkpoint_on_restart;
     bool checkpoint_files_output;
     int  compute_new_dt_on_regrid;
+    int  async_output;
+    int  plot_compress;
+    Real plot_compress_tol;
+    int  checkpoint_compress;
+    //
+    // With async_output the .temp directories of plotfiles and checkpoints
+    // are only renamed once their data is on disk.  That is waited for
+    // before the first output of a later step (async_step is the step of
+    // the pending ones) or before a file is written again, so a plotfile
+    // and a checkpoint of the same step are written together.
+    //
+    std::list< std::pair<std::string,std::string> > async_renames;
+    int                                             async_step = -1;
+
+    void
+    FinishAsyncOutput (int step = -1, const std::string& file = std::string())
+    {
+        if (async_renames.empty()) return;
+
+        if (step == async_step)
+        {
+            bool pending = false;
+            for (std::list< std::pair<std::string,std::string> >::const_iterator it = async_renames.begin();
+                 it != async_renames.end(); ++it)
+            {
+                pending = pending || (it->second == file);
+            }
+            if (!pending) return;
+        }
+
+        VisMF::AsyncWait();
+
+        ParallelDescriptor::Barrier("FinishAsyncOutput");
+
+        if (ParallelDescriptor::IOProcessor())
+        {
+            for (std::list< std::pair<std::string,std::string> >::const_iterator it = async_renames.begin();
+                 it != async_renames.end(); ++it)
+            {
+                std::rename(it->first.c_str(), it->second.c_str());
+            }
+        }
+        async_renames.clear();
+
+        ParallelDescriptor::Barrier("FinishAsyncOutput::rename");
+    }
 }
 
 void
@@ -106,10 +153,15 @@ Amr::Initialize ()
     checkpoint_nfiles        = 64;
     regrid_on_restart        = 0;
     use_efficient_regrid     = 0;
+    incremental_regrid       = 0;
     plotfile_on_restart      = 0;
     checkpoint_on_restart    = 0;
     checkpoint_files_output  = true;
     compute_new_dt_on_regrid = 0;
+    async_output             = 0;
+    plot_compress            = 0;
+    plot_compress_tol        = 0;
+    checkpoint_compress      = 0;
 
     BoxLib::ExecOnFinalize(Amr::Finalize);
 
@@ -129,6 +181,8 @@ Amr::Finalize ()
 
 bool Amr::Plot_Files_Output () { return plot_files_output; }
 
+bool Amr::IncrementalRegrid () { return incremental_regrid; }
+
 std::ostream&
 Amr::DataLog (int i)
 {
@@ -237,6 +291,7 @@ Amr::InitAmr ()
     //
     pp.query("regrid_on_restart",regrid_on_restart);
     pp.query("use_efficient_regrid",use_efficient_regrid);
+    pp.query("incremental_regrid",incremental_regrid);
     pp.query("plotfile_on_restart",plotfile_on_restart);
     pp.query("checkpoint_on_restart",checkpoint_on_restart);
 
@@ -583,6 +638,8 @@ Amr::deleteDerivePlotVar (const std::string& name)
 
 Amr::~Amr ()
 {
+    FinishAsyncOutput();
+
     levelbld->variableCleanUp();
 
     Amr::Finalize();
@@ -710,6 +767,8 @@ Amr::writePlotFile ()
 
     const std::string& pltfile = BoxLib::Concatenate(plot_file_root,level_steps[0],file_name_digits);
 
+    FinishAsyncOutput(level_steps[0], pltfile);
+
     if (verbose > 0 && ParallelDescriptor::IOProcessor())
         std::cout << "PLOTFILE: file = " << pltfile << '\n';
 
@@ -754,8 +813,16 @@ Amr::writePlotFile ()
         old_prec = HeaderFile.precision(15);
     }
 
+    VisMF::SetAsyncWrite(async_output);
+    VisMF::SetCompression(plot_compress, plot_compress_tol);
+
+    const VisMF::How how = (plot_nfiles == 0) ? VisMF::OneFile : VisMF::OneFilePerCPU;
+
     for (int k(0); k <= finest_level; ++k)
-        amr_level[k].writePlotFile(pltfileTemp, HeaderFile);
+        amr_level[k].writePlotFile(pltfileTemp, HeaderFile, how);
+
+    VisMF::SetAsyncWrite(false);
+    VisMF::SetCompression(false);
 
     if (ParallelDescriptor::IOProcessor())
     {
@@ -776,12 +843,20 @@ Amr::writePlotFile ()
         if (ParallelDescriptor::IOProcessor())
             std::cout << "Write plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
-    ParallelDescriptor::Barrier("Amr::writePlotFile::end");
+    if (async_output)
+    {
+        async_renames.push_back(std::make_pair(pltfileTemp, pltfile));
+        async_step = level_steps[0];
+    }
+    else
+    {
+        ParallelDescriptor::Barrier("Amr::writePlotFile::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     //
     // the plotfile file now has the regular name
     //
@@ -814,6 +889,8 @@ Amr::writeSmallPlotFile ()
 
     const std::string& pltfile = BoxLib::Concatenate(small_plot_file_root,level_steps[0],file_name_digits);
 
+    FinishAsyncOutput(level_steps[0], pltfile);
+
     if (verbose > 0 && ParallelDescriptor::IOProcessor())
         std::cout << "SMALL PLOTFILE: file = " << pltfile << '\n';
 
@@ -858,8 +935,16 @@ Amr::writeSmallPlotFile ()
         old_prec = HeaderFile.precision(15);
     }
 
+    VisMF::SetAsyncWrite(async_output);
+    VisMF::SetCompression(plot_compress, plot_compress_tol);
+
+    const VisMF::How how = (plot_nfiles == 0) ? VisMF::OneFile : VisMF::OneFilePerCPU;
+
     for (int k(0); k <= finest_level; ++k)
-        amr_level[k].writeSmallPlotFile(pltfileTemp, HeaderFile);
+        amr_level[k].writeSmallPlotFile(pltfileTemp, HeaderFile, how);
+
+    VisMF::SetAsyncWrite(false);
+    VisMF::SetCompression(false);
 
     if (ParallelDescriptor::IOProcessor())
     {
@@ -880,12 +965,20 @@ Amr::writeSmallPlotFile ()
         if (ParallelDescriptor::IOProcessor())
             std::cout << "Write small plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
-    ParallelDescriptor::Barrier("Amr::writeSmallPlotFile::end");
+    if (async_output)
+    {
+        async_renames.push_back(std::make_pair(pltfileTemp, pltfile));
+        async_step = level_steps[0];
+    }
+    else
+    {
+        ParallelDescriptor::Barrier("Amr::writeSmallPlotFile::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary plotfile.");
     //
     // the plotfile file now has the regular name
     //
@@ -1520,6 +1613,8 @@ Amr::checkPoint ()
 
     const std::string& ckfile = BoxLib::Concatenate(check_file_root,level_steps[0],file_name_digits);
 
+    FinishAsyncOutput(level_steps[0], ckfile);
+
     if (verbose > 0 && ParallelDescriptor::IOProcessor())
         std::cout << "CHECKPOINT: file = " << ckfile << std::endl;
 
@@ -1590,8 +1685,16 @@ Amr::checkPoint ()
         HeaderFile << '\n';
     }
 
+    VisMF::SetAsyncWrite(async_output);
+    VisMF::SetCompression(checkpoint_compress);
+
+    const VisMF::How how = (checkpoint_nfiles == 0) ? VisMF::OneFile : VisMF::OneFilePerCPU;
+
     for (int i = 0; i <= finest_level; ++i)
-        amr_level[i].checkPoint(ckfileTemp, HeaderFile);
+        amr_level[i].checkPoint(ckfileTemp, HeaderFile, how);
+
+    VisMF::SetAsyncWrite(false);
+    VisMF::SetCompression(false);
 
     if (ParallelDescriptor::IOProcessor())
     {
@@ -1620,12 +1723,20 @@ Amr::checkPoint ()
         if (ParallelDescriptor::IOProcessor())
             std::cout << "checkPoint() time = " << dCheckPointTime << " secs." << '\n';
     }
-    ParallelDescriptor::Barrier("Amr::checkPoint::end");
+    if (async_output)
+    {
+        async_renames.push_back(std::make_pair(ckfileTemp, ckfile));
+        async_step = level_steps[0];
+    }
+    else
+    {
+        ParallelDescriptor::Barrier("Amr::checkPoint::end");
 
-    if(ParallelDescriptor::IOProcessor()) {
-      std::rename(ckfileTemp.c_str(), ckfile.c_str());
+        if(ParallelDescriptor::IOProcessor()) {
+          std::rename(ckfileTemp.c_str(), ckfile.c_str());
+        }
+        ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
     }
-    ParallelDescriptor::Barrier("Renaming temporary checkPoint file.");
 
   }  // end while
 
@@ -2227,8 +2338,59 @@ Amr::regrid (int  lbase,
         //
         // Construct skeleton of new level.
         //
+        AmrLevel* a;
+
+        if (incremental_regrid && !initial && amr_level.defined(lev) &&
+            AmrLevel::get_desc_lst().size() > 0)
+        {
+            //
+            // Keep unchanged grids on the CPUs holding their data.  Every
+            // MultiFab built on the new grids without a map gets the cached
+            // map for that number of boxes, so ours has to become the cached
+            // one.  A cached map only the old level uses can go, since that
+            // level is replaced here.  One a level of this regrid (or a kept
+            // level) still uses stays; the new level then takes it and
+            // FillPatchFromOld() moves whatever it can.
+            //
+            const BoxArray&            ba     = new_grid_places[lev];
+            const DistributionMapping& dm_old = amr_level[lev].get_new_data(0).DistributionMap();
 
-        AmrLevel* a = (*levelbld)(*this,lev,Geom(lev),new_grid_places[lev],cumtime);
+            DistributionMapping dm;
+
+            bool keep_in_place = true;
+
+            if (DistributionMapping::MapInCache(ba.size()))
+            {
+                dm.define(ba, ParallelDescriptor::NProcs());
+
+                keep_in_place = DistributionMapping::SameRefs(dm, dm_old);
+
+                for (int k = 0; k < lev && keep_in_place; ++k)
+                    if (DistributionMapping::SameRefs(dm, amr_level[k].get_new_data(0).DistributionMap()))
+                        keep_in_place = false;
+
+                if (!keep_in_place && verbose > 0 && ParallelDescriptor::IOProcessor())
+                    std::cout << "Amr::regrid(): level " << lev << " takes the cached map for "
+                              << ba.size() << " grids used by another level\n";
+            }
+
+            if (keep_in_place)
+            {
+                dm = DistributionMapping();
+                dm.define(ba, ParallelDescriptor::NProcs(), amr_level[lev].boxArray(), dm_old);
+
+                DistributionMapping::ReplaceInCache(dm);
+            }
+
+            a = (*levelbld)(*this,lev,Geom(lev),ba,dm,cumtime);
+
+            if (a->get_new_data(0).DistributionMap() != dm)
+                BoxLib::Abort("Amr::regrid(): new level not built with the incremental_regrid map");
+        }
+        else
+        {
+            a = (*levelbld)(*this,lev,Geom(lev),new_grid_places[lev],cumtime);
+        }
 
         if (initial)
         {
@@ -2296,6 +2458,10 @@ Amr::regrid (int  lbase,
           MultiFab::MoveAllFabs(mLDM[iMap]);
         }
     }
+    //
+    // The FABs of the old grids are gone; don't keep their memory pooled.
+    //
+    BoxLib::ReleaseArenaCache();
 
 #ifdef USE_STATIONDATA
     station.findGrid(amr_level,Geom());
@@ -2842,8 +3008,17 @@ Amr::initPltAndChk ()
 
     pp.query("plot_nfiles", plot_nfiles);
     pp.query("checkpoint_nfiles", checkpoint_nfiles);
+    pp.query("async_output", async_output);
+    //
+    // Compressed FABs; plotfiles may be lossy, to within plot_compress_tol
+    // of each component's range in a FAB.
+    //
+    pp.query("plot_compress", plot_compress);
+    pp.query("plot_compress_tol", plot_compress_tol);
+    pp.query("checkpoint_compress", checkpoint_compress);
     //
     // -1 ==> use ParallelDescriptor::NProcs().
+    //  0 ==> one shared file per MultiFab (VisMF::OneFile).
     //
     if (plot_nfiles       == -1) plot_nfiles       = ParallelDescriptor::NProcs();
     if (checkpoint_nfiles == -1) checkpoint_nfiles = ParallelDescriptor::NProcs();
@@ -3105,6 +3280,9 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         allInts.push_back(plotfile_on_restart);
         allInts.push_back(checkpoint_on_restart);
         allInts.push_back(compute_new_dt_on_regrid);
+        allInts.push_back(async_output);
+        allInts.push_back(plot_compress);
+        allInts.push_back(checkpoint_compress);
         allInts.push_back(use_fixed_upto_level);
 
         allInts.push_back(level_steps.size());
@@ -3170,6 +3348,9 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         plotfile_on_restart        = allInts[count++];
         checkpoint_on_restart      = allInts[count++];
         compute_new_dt_on_regrid   = allInts[count++];
+        async_output               = allInts[count++];
+        plot_compress              = allInts[count++];
+        checkpoint_compress        = allInts[count++];
         use_fixed_upto_level       = allInts[count++];
 
         aSize                      = allInts[count++];
@@ -3217,6 +3398,7 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         allReals.push_back(check_per);
         allReals.push_back(plot_per);
         allReals.push_back(small_plot_per);
+        allReals.push_back(plot_compress_tol);
 
         for(int i(0); i < dt_level.size(); ++i)   { allReals.push_back(dt_level[i]); }
         for(int i(0); i < dt_min.size(); ++i)     { allReals.push_back(dt_min[i]); }
@@ -3235,6 +3417,7 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         check_per  = allReals[count++];
         plot_per   = allReals[count++];
         small_plot_per = allReals[count++];
+        plot_compress_tol = allReals[count++];
 
 	dt_level.resize(dt_level_Size);
         for(int i(0); i < dt_level.size(); ++i)  { dt_level[i] = allReals[count++]; }
@@ -474,6 +474,26 @@ FillPatchIterator::FillPatchIterator (AmrLevel& amrlevel,
 #endif
 }
 
+FillPatchIterator::FillPatchIterator (AmrLevel&         amrlevel,
+                                      MultiFab&         leveldata,
+                                      int               boxGrow,
+                                      Real              time,
+                                      const Array<int>& index,
+                                      const Array<int>& scomp,
+                                      const Array<int>& ncomp)
+    :
+    MFIter(leveldata),
+    m_amrlevel(amrlevel),
+    m_leveldata(leveldata),
+    m_ncomp(0)
+{
+    Initialize(boxGrow,time,index,scomp,ncomp);
+
+#if BL_USE_TEAM
+    ParallelDescriptor::MyTeam().MemoryBarrier();
+#endif
+}
+
 static
 bool
 NeedToTouchUpPhysCorners (const Geometry& geom)
@@ -749,43 +769,75 @@ FillPatchIterator::Initialize (int  boxGrow,
                                int  index,
                                int  scomp,
                                int  ncomp)
+{
+    Initialize(boxGrow,time,Array<int>(1,index),Array<int>(1,scomp),Array<int>(1,ncomp));
+}
+
+void
+FillPatchIterator::Initialize (int               boxGrow,
+                               Real              time,
+                               const Array<int>& index,
+                               const Array<int>& scomp,
+                               const Array<int>& ncomp)
 {
     BL_PROFILE("FillPatchIterator::Initialize");
 
-    BL_ASSERT(scomp >= 0);
-    BL_ASSERT(ncomp >= 1);
-    BL_ASSERT(0 <= index && index < AmrLevel::desc_lst.size());
+    const int NS = index.size();
+
+    BL_ASSERT(NS >= 1);
+    BL_ASSERT(scomp.size() == NS && ncomp.size() == NS);
 
-    const StateDescriptor& desc = AmrLevel::desc_lst[index];
+    m_ncomp = 0;
 
-    m_ncomp = ncomp;
-    m_range = desc.sameInterps(scomp,ncomp);
+    for (int k = 0; k < NS; ++k)
+    {
+        BL_ASSERT(scomp[k] >= 0);
+        BL_ASSERT(ncomp[k] >= 1);
+        BL_ASSERT(0 <= index[k] && index[k] < AmrLevel::desc_lst.size());
+        BL_ASSERT(AmrLevel::desc_lst[index[k]].inRange(scomp[k],ncomp[k]));
+        //
+        // The batched fill uses the FB and CPCs of m_fabs for all of them.
+        //
+        if (AmrLevel::desc_lst[index[k]].getType() != m_leveldata.boxArray().ixType())
+            BoxLib::Abort("FillPatchIterator: state types must have the index type of leveldata");
 
-    m_fabs.define(m_leveldata.boxArray(),m_ncomp,boxGrow,Fab_allocate);
+        m_ncomp += ncomp[k];
+    }
 
-    BL_ASSERT(m_leveldata.DistributionMap() == m_fabs.DistributionMap());
+    m_fabs.define(m_leveldata.boxArray(),m_ncomp,boxGrow,m_leveldata.DistributionMap(),Fab_allocate);
 
     const IndexType& boxType = m_leveldata.boxArray().ixType();
     const int level = m_amrlevel.level;
+    //
+    // The components with the same interpolater that can be filled from
+    // this level and the next coarser one are collected and filled
+    // together.  The others are filled one range at a time.
+    //
+    Array<int> p_index, p_scomp, p_dcomp, p_ncomp;
 
-    for (int i = 0, DComp = 0; i < m_range.size(); i++)
+    for (int k = 0, DComp = 0; k < NS; ++k)
     {
-        const int SComp = m_range[i].first;
-        const int NComp = m_range[i].second;
+        const StateDescriptor& desc = AmrLevel::desc_lst[index[k]];
 
-	if (level == 0)
-	{
-	    FillFromLevel0(time, index, SComp, DComp, NComp);
-	}
-	else
-	{
-	    if (level == 1 || 
-		BoxLib::ProperlyNested(m_amrlevel.crse_ratio,
-				       m_amrlevel.parent->blockingFactor(m_amrlevel.level),
-				       boxGrow, boxType, desc.interp(SComp)))
-	    {
-		FillFromTwoLevels(time, index, SComp, DComp, NComp);
-	    } else {
+        const std::vector< std::pair<int,int> >& range = desc.sameInterps(scomp[k],ncomp[k]);
+
+        for (int i = 0; i < range.size(); i++)
+        {
+            const int SComp = range[i].first;
+            const int NComp = range[i].second;
+
+            if (level == 0 || level == 1 ||
+                BoxLib::ProperlyNested(m_amrlevel.crse_ratio,
+                                       m_amrlevel.parent->blockingFactor(m_amrlevel.level),
+                                       boxGrow, boxType, desc.interp(SComp)))
+            {
+                p_index.push_back(index[k]);
+                p_scomp.push_back(SComp);
+                p_dcomp.push_back(DComp);
+                p_ncomp.push_back(NComp);
+            }
+            else
+            {
 		static bool first = true;
 		if (first) {
 		    first = false;
@@ -816,7 +868,7 @@ FillPatchIterator::Initialize (int  boxGrow,
 						  m_leveldata,
 						  boxGrow,
 						  time,
-						  index,
+						  index[k],
 						  SComp,
 						  NComp,
 						  desc.interp(SComp));
@@ -832,42 +884,83 @@ FillPatchIterator::Initialize (int  boxGrow,
 		}
 		
 		delete fph;
-	    }
-	}
+            }
 
-        DComp += NComp;
+            DComp += NComp;
+        }
+    }
+
+    if (!p_index.empty())
+    {
+        if (level == 0)
+        {
+            FillFromLevel0(time, p_index, p_scomp, p_dcomp, p_ncomp);
+        }
+        else
+        {
+            FillFromTwoLevels(time, p_index, p_scomp, p_dcomp, p_ncomp);
+        }
     }
     //
     // Call hack to touch up fillPatched data.
     //
-    m_amrlevel.set_preferred_boundary_values(m_fabs,
-                                             index,
-                                             scomp,
-                                             0,
-                                             ncomp,
-                                             time);
+    for (int k = 0, DComp = 0; k < NS; ++k)
+    {
+        m_amrlevel.set_preferred_boundary_values(m_fabs,
+                                                 index[k],
+                                                 scomp[k],
+                                                 DComp,
+                                                 ncomp[k],
+                                                 time);
+        DComp += ncomp[k];
+    }
 }
 
 void
-FillPatchIterator::FillFromLevel0 (Real time, int index, int scomp, int dcomp, int ncomp)
+FillPatchIterator::FillFromLevel0 (Real              time,
+                                   const Array<int>& index,
+                                   const Array<int>& scomp,
+                                   const Array<int>& dcomp,
+                                   const Array<int>& ncomp)
 {
     BL_ASSERT(m_amrlevel.level == 0);
 
-    StateData& statedata = m_amrlevel.state[index];
-
-    PArray<MultiFab> smf;
-    std::vector<Real> stime;
-    statedata.getData(smf,stime,time);
+    const int N = index.size();
 
     const Geometry& geom = m_amrlevel.geom;
 
-    StateDataPhysBCFunct physbcf(statedata,scomp,geom);
+    PArray< PArray<MultiFab> >    smf(N,PArrayManage);
+    Array< std::vector<Real> >    stime(N);
+    PArray<StateDataPhysBCFunct>  physbcf(N,PArrayManage);
+    Array<BoxLib::FillPatchPiece> pieces(N);
+
+    for (int k = 0; k < N; ++k)
+    {
+        StateData& statedata = m_amrlevel.state[index[k]];
+
+        smf.set(k, new PArray<MultiFab>);
+        statedata.getData(smf[k],stime[k],time);
+        physbcf.set(k, new StateDataPhysBCFunct(statedata,scomp[k],geom));
 
-    BoxLib::FillPatchSingleLevel (m_fabs, time, smf, stime, scomp, dcomp, ncomp, geom, physbcf);
+        BoxLib::FillPatchPiece& p = pieces[k];
+
+        p.scomp = scomp[k];
+        p.dcomp = dcomp[k];
+        p.ncomp = ncomp[k];
+        p.fmf   = &smf[k];
+        p.ft    = &stime[k];
+        p.fbc   = &physbcf[k];
+    }
+
+    BoxLib::FillPatchSingleLevel(m_fabs, time, pieces, geom);
 }
 
 void
-FillPatchIterator::FillFromTwoLevels (Real time, int index, int scomp, int dcomp, int ncomp)
+FillPatchIterator::FillFromTwoLevels (Real              time,
+                                      const Array<int>& index,
+                                      const Array<int>& scomp,
+                                      const Array<int>& dcomp,
+                                      const Array<int>& ncomp)
 {
     int ilev_fine = m_amrlevel.level;
     int ilev_crse = ilev_fine-1;
@@ -879,29 +972,46 @@ FillPatchIterator::FillFromTwoLevels (Real time, int index, int scomp, int dcomp
 
     const Geometry& geom_fine = fine_level.geom;
     const Geometry& geom_crse = crse_level.geom;
-    
-    PArray<MultiFab> smf_crse;
-    std::vector<Real> stime_crse;
-    StateData& statedata_crse = crse_level.state[index];
-    statedata_crse.getData(smf_crse,stime_crse,time);
-    StateDataPhysBCFunct physbcf_crse(statedata_crse,scomp,geom_crse);
-
-    PArray<MultiFab> smf_fine;
-    std::vector<Real> stime_fine;
-    StateData& statedata_fine = fine_level.state[index];
-    statedata_fine.getData(smf_fine,stime_fine,time);
-    StateDataPhysBCFunct physbcf_fine(statedata_fine,scomp,geom_fine);
-
-    const StateDescriptor& desc = AmrLevel::desc_lst[index];
-
-    BoxLib::FillPatchTwoLevels(m_fabs, time, 
-			       smf_crse, stime_crse, 
-			       smf_fine, stime_fine,
-			       scomp, dcomp, ncomp, 
-			       geom_crse, geom_fine,
-			       physbcf_crse, physbcf_fine,
-			       crse_level.fineRatio(), 
-			       desc.interp(scomp), desc.getBCs());
+
+    const int N = index.size();
+
+    PArray< PArray<MultiFab> >    smf_crse(N,PArrayManage), smf_fine(N,PArrayManage);
+    Array< std::vector<Real> >    stime_crse(N), stime_fine(N);
+    PArray<StateDataPhysBCFunct>  physbcf_crse(N,PArrayManage), physbcf_fine(N,PArrayManage);
+    Array<BoxLib::FillPatchPiece> pieces(N);
+
+    for (int k = 0; k < N; ++k)
+    {
+        StateData& statedata_crse = crse_level.state[index[k]];
+        smf_crse.set(k, new PArray<MultiFab>);
+        statedata_crse.getData(smf_crse[k],stime_crse[k],time);
+        physbcf_crse.set(k, new StateDataPhysBCFunct(statedata_crse,scomp[k],geom_crse));
+
+        StateData& statedata_fine = fine_level.state[index[k]];
+        smf_fine.set(k, new PArray<MultiFab>);
+        statedata_fine.getData(smf_fine[k],stime_fine[k],time);
+        physbcf_fine.set(k, new StateDataPhysBCFunct(statedata_fine,scomp[k],geom_fine));
+
+        const StateDescriptor& desc = AmrLevel::desc_lst[index[k]];
+
+        BoxLib::FillPatchPiece& p = pieces[k];
+
+        p.scomp  = scomp[k];
+        p.dcomp  = dcomp[k];
+        p.ncomp  = ncomp[k];
+        p.fmf    = &smf_fine[k];
+        p.ft     = &stime_fine[k];
+        p.fbc    = &physbcf_fine[k];
+        p.cmf    = &smf_crse[k];
+        p.ct     = &stime_crse[k];
+        p.cbc    = &physbcf_crse[k];
+        p.mapper = desc.interp(scomp[k]);
+        p.bcs    = &desc.getBCs();
+    }
+
+    BoxLib::FillPatchTwoLevels(m_fabs, time, pieces,
+                               geom_crse, geom_fine,
+                               crse_level.fineRatio());
 }
 
 static
@@ -1880,6 +1990,78 @@ AmrLevel::FillPatch(AmrLevel& amrlevel,
 
 
 
+void
+AmrLevel::FillPatchFromOld (AmrLevel& old,
+                            int       index,
+                            Real      time)
+{
+    MultiFab& S_new = get_new_data(index);
+
+    const int ncomp = S_new.nComp();
+
+    StateData& old_state = old.state[index];
+
+    if (!Amr::IncrementalRegrid()            ||
+        time != old_state.curTime()          ||
+        old_state.newData().nComp() != ncomp ||
+        old_state.newData().nGrow() != S_new.nGrow() ||
+        ParallelDescriptor::TeamSize() > 1)
+    {
+        FillPatch(old, S_new, 0, time, index, 0, ncomp);
+        return;
+    }
+
+    BL_PROFILE("AmrLevel::FillPatchFromOld()");
+
+    MultiFab& S_old = old_state.newData();
+
+    const BoxArray&            ba_new = S_new.boxArray();
+    const BoxArray&            ba_old = S_old.boxArray();
+    const DistributionMapping& dm_new = S_new.DistributionMap();
+    const DistributionMapping& dm_old = S_old.DistributionMap();
+
+    const int MyProc = ParallelDescriptor::MyProc();
+
+    BoxList bl_rest(ba_new.ixType());
+
+    std::vector< std::pair<int,Box> > isects;
+
+    for (int i = 0, N = ba_new.size(); i < N; i++)
+    {
+        int j = -1;
+
+        ba_old.intersections(ba_new[i],isects);
+
+        for (int k = 0, M = isects.size(); k < M && j < 0; k++)
+        {
+            const int jj = isects[k].first;
+
+            if (ba_old[jj] == ba_new[i] && dm_old[jj] == dm_new[i])
+                j = jj;
+        }
+
+        if (j < 0)
+            bl_rest.push_back(ba_new[i]);
+        else if (dm_new[i] == MyProc)
+            S_new.swapFab(i, S_old, j);
+    }
+
+    if (bl_rest.isEmpty()) return;
+    //
+    // The grids that changed are filled on the CPUs that own them.
+    //
+    const BoxArray ba_rest(bl_rest);
+
+    DistributionMapping dm_rest;
+    dm_rest.define(ba_rest, ParallelDescriptor::NProcs(), ba_new, dm_new);
+
+    MultiFab tmp(ba_rest, ncomp, 0, dm_rest);
+
+    FillPatch(old, tmp, 0, time, index, 0, ncomp);
+
+    S_new.copy(tmp, 0, 0, ncomp);
+}
+
 void
 AmrLevel::AddProcsToComp(Amr *aptr, int nSidecarProcs, int prevSidecarProcs,
                          int ioProcNumSCS, int ioProcNumAll, int scsMyId,
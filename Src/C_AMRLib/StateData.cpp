@@ -289,7 +289,6 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
     //
     if (nsets >= 1)
     {
-        MultiFab new_data_in;
         is >> mf_name;
         //
         // Note that mf_name is relative to the Header file.
@@ -299,20 +298,17 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
         if (!chkfile.empty() && chkfile[chkfile.length()-1] != '/')
             FullPathName += '/';
         FullPathName += mf_name;
-        VisMF::Read(new_data_in, FullPathName);
-
-	BL_ASSERT(BoxLib::match(grids,new_data_in.boxArray()));
-	BL_ASSERT(new_data->nComp() == new_data_in.nComp());
-	BL_ASSERT(new_data->nGrow() == new_data_in.nGrow());
-
-	MultiFab::Copy(*new_data, new_data_in, 0, 0, new_data->nComp(), new_data->nGrow());
+        //
+        // Read just what our FABs need; a checkpoint with more components
+        // than desc has is fine.
+        //
+        VisMF::ReadInto(*new_data, FullPathName, 0, 0, new_data->nComp());
     }
     //
     // This reads the "old" data, if it's there.
     //
     if (nsets == 2)
     {
-        MultiFab old_data_in;
         is >> mf_name;
         //
         // Note that mf_name is relative to the Header file.
@@ -322,13 +318,11 @@ StateData::restartDoit (std::istream& is, const std::string& chkfile)
         if (!chkfile.empty() && chkfile[chkfile.length()-1] != '/')
             FullPathName += '/';
         FullPathName += mf_name;
-        VisMF::Read(old_data_in, FullPathName);
-
-	BL_ASSERT(BoxLib::match(grids,old_data_in.boxArray()));
-	BL_ASSERT(old_data->nComp() == old_data_in.nComp());
-	BL_ASSERT(old_data->nGrow() == old_data_in.nGrow());
-
-	MultiFab::Copy(*old_data, old_data_in, 0, 0, old_data->nComp(), old_data->nGrow());
+        //
+        // Read just what our FABs need; a checkpoint with more components
+        // than desc has is fine.
+        //
+        VisMF::ReadInto(*old_data, FullPathName, 0, 0, old_data->nComp());
     }
 }
 
@@ -13,6 +13,64 @@
 namespace
 {
     bool initialized = false;
+    //
+    // Replaces bl on every CPU by the boxes in bl on all CPUs, in CPU order.
+    //
+    void
+    AllGatherBoxes (BoxList& bl)
+    {
+#if BL_USE_MPI
+        const int NProcs = ParallelDescriptor::NProcs();
+
+        if (NProcs == 1) return;
+
+        Array<int> sendbuf;
+
+        sendbuf.reserve(bl.size() * 2 * BL_SPACEDIM);
+
+        for (BoxList::const_iterator it = bl.begin(), End = bl.end(); it != End; ++it)
+        {
+            BL_ASSERT(it->cellCentered());
+
+            for (int d = 0; d < BL_SPACEDIM; d++)
+                sendbuf.push_back(it->smallEnd(d));
+            for (int d = 0; d < BL_SPACEDIM; d++)
+                sendbuf.push_back(it->bigEnd(d));
+        }
+
+        int count = sendbuf.size();
+
+        Array<int> counts(NProcs), offsets(NProcs,0);
+
+        BL_MPI_REQUIRE( MPI_Allgather(&count,
+                                      1,
+                                      ParallelDescriptor::Mpi_typemap<int>::type(),
+                                      counts.dataPtr(),
+                                      1,
+                                      ParallelDescriptor::Mpi_typemap<int>::type(),
+                                      ParallelDescriptor::Communicator()) );
+
+        for (int i = 1; i < NProcs; i++)
+            offsets[i] = offsets[i-1] + counts[i-1];
+
+        const int total = offsets[NProcs-1] + counts[NProcs-1];
+
+        Array<int> recvbuf(std::max(total,1));
+
+        BL_MPI_REQUIRE( MPI_Allgatherv(sendbuf.dataPtr(),
+                                       count,
+                                       ParallelDescriptor::Mpi_typemap<int>::type(),
+                                       recvbuf.dataPtr(),
+                                       counts.dataPtr(),
+                                       offsets.dataPtr(),
+                                       ParallelDescriptor::Mpi_typemap<int>::type(),
+                                       ParallelDescriptor::Communicator()) );
+        bl.clear();
+
+        for (int i = 0; i < total; i += 2*BL_SPACEDIM)
+            bl.push_back(Box(IntVect(&recvbuf[i]), IntVect(&recvbuf[i+BL_SPACEDIM])));
+#endif
+    }
 }
 
 void
@@ -61,6 +119,8 @@ AmrCore::InitAmrCore (int max_level_in, const Array<int>& n_cell_in)
     use_fixed_upto_level   = 0;
 
     refine_grid_layout = true;
+
+    distributed_clustering = false;
     
     ParmParse pp("amr");
 
@@ -210,6 +270,9 @@ AmrCore::InitAmrCore (int max_level_in, const Array<int>& n_cell_in)
 
 	// chop up grids to have more grids than the number of procs
 	pp.query("refine_grid_layout", refine_grid_layout);
+
+	// cluster each CPU's tags on that CPU instead of all of them everywhere
+	pp.query("distributed_clustering", distributed_clustering);
     }
 
     finest_level = -1;
@@ -512,10 +575,20 @@ AmrCore::MakeNewGrids (int lbase, Real time, int& new_finest, Array<BoxArray>& n
         // Create initial cluster containing all tagged points.
         //
 	std::vector<IntVect> tagvec;
-	tags.collate(tagvec);
+        BoxList              region;
+
+        if (distributed_clustering)
+            tags.collateOwned(tagvec,region);
+        else
+            tags.collate(tagvec);
         tags.clear();
 
-        if (tagvec.size() > 0)
+        long ntags = tagvec.size();
+
+        if (distributed_clustering)
+            ParallelDescriptor::ReduceLongSum(ntags);
+
+        if (ntags > 0)
         {
             //
             // Created new level, now generate efficient grids.
@@ -523,21 +596,49 @@ AmrCore::MakeNewGrids (int lbase, Real time, int& new_finest, Array<BoxArray>& n
             if ( !(useFixedCoarseGrids() && levc<useFixedUpToLevel()) ) {
                 new_finest = std::max(new_finest,levf);
 	    }
-            //
-            // Construct initial cluster.
-            //
-            ClusterList clist(&tagvec[0], tagvec.size());
-            clist.chop(grid_eff);
-            BoxDomain bd;
-            bd.add(p_n[levc]);
-            clist.intersect(bd);
-            bd.clear();
+            BoxList new_bx;
+
+            if (distributed_clustering)
+            {
+                //
+                // Each CPU clusters its own tags, keeping the clusters inside
+                // its region.  The regions are disjoint, so are the boxes
+                // from different CPUs; only those are exchanged.
+                //
+                if (!tagvec.empty())
+                {
+                    ClusterList clist(&tagvec[0], tagvec.size());
+                    clist.chop(grid_eff);
+                    BoxDomain bd;
+                    bd.add(region);
+                    clist.intersect(bd);
+                    bd.clear();
+                    bd.add(p_n[levc]);
+                    clist.intersect(bd);
+                    bd.clear();
+                    clist.boxList(new_bx);
+                }
+                region.clear();
+
+                AllGatherBoxes(new_bx);
+            }
+            else
+            {
+                //
+                // Construct initial cluster.
+                //
+                ClusterList clist(&tagvec[0], tagvec.size());
+                clist.chop(grid_eff);
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+                clist.boxList(new_bx);
+            }
             //
             // Efficient properly nested Clusters have been constructed
             // now generate list of grids at level levf.
             //
-            BoxList new_bx;
-            clist.boxList(new_bx);
             new_bx.refine(bf_lev[levc]);
             new_bx.simplify();
             BL_ASSERT(new_bx.isDisjoint());
@@ -433,13 +433,26 @@ ClusterList::intersect (const BoxDomain& dom)
     // We'll use this to speed up the contains() test below.
     //
     BoxArray domba(dom.boxList());
+    //
+    // The boxes of a BoxDomain are disjoint, so c's box is in dom if its
+    // intersections with domba add up to it.  (Checked here rather than in
+    // BoxArray::contains(), whose assertion would check it for every cluster.)
+    //
+    BL_ASSERT(domba.isDisjoint());
+
+    std::vector< std::pair<int,Box> > isects;
 
     for (std::list<Cluster*>::iterator cli = lst.begin(); cli != lst.end(); )
     {
         Cluster* c = *cli;
 
-	bool assume_disjoint_ba = true;
-        if (domba.contains(c->box(),assume_disjoint_ba))
+        domba.intersections(c->box(),isects);
+
+        long npts = 0;
+        for (int i = 0, N = isects.size(); i < N; i++)
+            npts += isects[i].second.numPts();
+
+        if (npts == c->box().numPts())
         {
             ++cli;
         }
@@ -1,11 +1,179 @@
 
 #include <FillPatchUtil.H>
 #include <cmath>
+#include <map>
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+namespace
+{
+    //
+    // Interpolates smf in time into components [dcomp,dcomp+ncomp) of dmf,
+    // which has the BoxArray and DistributionMapping of smf[0], but only
+    // in the cells a copy into dst_ba grown by dst_ngrow will read.  The
+    // coarse patches of FillPatchTwoLevels cover a thin shell of the
+    // coarse level, so this is a small part of it.
+    //
+    void
+    TimeInterpForCopy (MultiFab&                dmf,
+		       int                      dcomp,
+		       const PArray<MultiFab>&  smf,
+		       const std::vector<Real>& stime,
+		       int                      scomp,
+		       int                      ncomp,
+		       Real                     time,
+		       const BoxArray&          dst_ba,
+		       int                      dst_ngrow,
+		       const Periodicity&       period)
+    {
+	BL_PROFILE("TimeInterpForCopy");
+
+	BL_ASSERT(smf.size() == 2);
+	BL_ASSERT(dmf.boxArray() == smf[0].boxArray());
+
+	const std::vector<IntVect>& pshifts = period.shiftIntVect();
+	//
+	// Each box is done by one thread, so that the regions of a box
+	// that overlap are only written by that thread.
+	//
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+	    std::vector< std::pair<int,Box> > isects;
+
+	    for (MFIter mfi(dmf); mfi.isValid(); ++mfi)
+	    {
+		const Box& vbx = mfi.validbox();
+
+		for (int ish = 0, NS = pshifts.size(); ish < NS; ++ish)
+		{
+		    const IntVect& iv = pshifts[ish];
+
+		    dst_ba.intersections(vbx+iv, isects, false, dst_ngrow);
+
+		    for (int j = 0, M = isects.size(); j < M; ++j)
+		    {
+			const Box bx = isects[j].second - iv;
+
+			dmf[mfi].linInterp(smf[0][mfi],
+					   scomp,
+					   smf[1][mfi],
+					   scomp,
+					   stime[0],
+					   stime[1],
+					   time,
+					   bx,
+					   dcomp,
+					   ncomp);
+		    }
+		}
+	    }
+	}
+    }
+    //
+    // One tile of coarse-to-fine interpolation: from coarse patch cidx into
+    // the region fbx of fine FAB fidx.
+    //
+    struct InterpTile
+    {
+	InterpTile (int c, int f, const Box& b) : cidx(c), fidx(f), fbx(b) {}
+	int cidx;
+	int fidx;
+	Box fbx;
+    };
+    //
+    // Cuts the fine region dbx into tiles.  For cell-centered data the tiles
+    // are unions of whole coarse cells, so that the interpolaters, whose
+    // slopes and limiters are local to a coarse cell, give the same results
+    // on the tiles as on dbx.  Node-centered regions are not cut.
+    //
+    void
+    MakeInterpTiles (std::vector<InterpTile>& tiles,
+		     int                      cidx,
+		     int                      fidx,
+		     const Box&               dbx,
+		     const IntVect&           ratio)
+    {
+	if (!dbx.ok()) return;
+
+	if (!dbx.ixType().cellCentered())
+	{
+	    tiles.push_back(InterpTile(cidx,fidx,dbx));
+	    return;
+	}
+	//
+	// No fewer than 4 coarse cells per direction, lest the one-sided
+	// slopes at physical boundaries change.
+	//
+	IntVect ctile;
+	for (int i = 0; i < BL_SPACEDIM; ++i)
+	    ctile[i] = std::max(FabArrayBase::mfiter_tile_size[i]/ratio[i], 4);
+
+	BoxList bl(BoxLib::coarsen(dbx,ratio));
+	bl.maxSize(ctile);
+
+	for (BoxList::const_iterator it = bl.begin(), End = bl.end(); it != End; ++it)
+	    tiles.push_back(InterpTile(cidx,fidx,BoxLib::refine(*it,ratio) & dbx));
+    }
+    //
+    // Interpolates pieces[ks[j]] from components pcomp[j] on of the coarse
+    // patches into the fine data, on all tiles in parallel if threadsafe,
+    // i.e., if no two tiles overlap.
+    //
+    void
+    InterpTiles (const std::vector<InterpTile>&          tiles,
+		 const MultiFab&                         crse,
+		 MultiFab&                               fine,
+		 Interpolater*                           mapper,
+		 const Array<BoxLib::FillPatchPiece>&    pieces,
+		 const Array<int>&                       ks,
+		 const Array<int>&                       pcomp,
+		 const Box&                              fdomain,
+		 const IntVect&                          ratio,
+		 const Geometry&                         cgeom,
+		 const Geometry&                         fgeom,
+		 bool                                    threadsafe)
+    {
+	BL_PROFILE("InterpTiles");
+
+	const int N = tiles.size();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if (threadsafe)
+#endif
+	for (int it = 0; it < N; ++it)
+	{
+	    const InterpTile& t = tiles[it];
+
+	    for (int j = 0, NG = ks.size(); j < NG; ++j)
+	    {
+		const BoxLib::FillPatchPiece& p = pieces[ks[j]];
+		//
+		// The BCs are those of the tile: physical only at the sides
+		// it shares with the domain.
+		//
+		Array<BCRec> bcr(p.ncomp);
+		BoxLib::setBC(t.fbx,fdomain,p.scomp,0,p.ncomp,*p.bcs,bcr);
+
+		mapper->interp(crse[t.cidx],
+			       pcomp[j],
+			       fine[t.fidx],
+			       p.dcomp,
+			       p.ncomp,
+			       t.fbx,
+			       ratio,
+			       cgeom,
+			       fgeom,
+			       bcr,
+			       0, 0);
+	    }
+	}
+    }
+}
+
 namespace BoxLib
 {
     bool ProperlyNested (const IntVect& ratio, int blocking_factor, int ngrow,
@@ -67,22 +235,30 @@ namespace BoxLib
 		sameba = false;
 	    }
 
+	    if (sameba)
+	    {
 #ifdef _OPENMP
 #pragma omp parallel 
 #endif
-	    for (MFIter mfi(*dmf,true); mfi.isValid(); ++mfi)
+		for (MFIter mfi(*dmf,true); mfi.isValid(); ++mfi)
+		{
+		    const Box& bx = mfi.tilebox();
+		    (*dmf)[mfi].linInterp(smf[0][mfi],
+					  scomp,
+					  smf[1][mfi],
+					  scomp,
+					  stime[0],
+					  stime[1],
+					  time,
+					  bx,
+					  destcomp,
+					  ncomp);
+		}
+	    }
+	    else
 	    {
-		const Box& bx = mfi.tilebox();
-		(*dmf)[mfi].linInterp(smf[0][mfi],
-				      scomp,
-				      smf[1][mfi],
-				      scomp,
-				      stime[0],
-				      stime[1],
-				      time,
-				      bx,
-				      destcomp,
-				      ncomp);
+		TimeInterpForCopy(*dmf, 0, smf, stime, scomp, ncomp, time,
+				  mf.boxArray(), mf.nGrow(), geom.periodicity());
 	    }
 	    
 	    if (sameba)
@@ -116,61 +292,269 @@ namespace BoxLib
 			     const IntVect& ratio, 
 			     Interpolater* mapper, const Array<BCRec>& bcs)
     {
-	BL_PROFILE("FillPatchTwoLevels");
+	Array<FillPatchPiece> pieces(1);
 
-	int ngrow = mf.nGrow();
-	    
-	if (ngrow > 0 || mf.getBDKey() != fmf[0].getBDKey()) 
+	FillPatchPiece& p = pieces[0];
+
+	p.scomp  = scomp;
+	p.dcomp  = dcomp;
+	p.ncomp  = ncomp;
+	p.fmf    = &fmf;
+	p.ft     = &ft;
+	p.fbc    = &fbc;
+	p.cmf    = &cmf;
+	p.ct     = &ct;
+	p.cbc    = &cbc;
+	p.mapper = mapper;
+	p.bcs    = &bcs;
+
+	FillPatchTwoLevels(mf, time, pieces, cgeom, fgeom, ratio);
+    }
+
+    FillPatchPiece::FillPatchPiece ()
+	:
+	scomp(0), dcomp(0), ncomp(0),
+	fmf(0), ft(0), fbc(0),
+	cmf(0), ct(0), cbc(0),
+	mapper(0), bcs(0)
+    {}
+
+    void FillPatchSingleLevel (MultiFab& mf, Real time,
+			       const Array<FillPatchPiece>& pieces,
+			       const Geometry& geom)
+    {
+	BL_PROFILE("FillPatchSingleLevel(pieces)");
+
+	const int N = pieces.size();
+	//
+	// The pieces whose data live on the BoxArray and DistributionMapping
+	// of mf are filled in the valid region here and then share one
+	// FillBoundary.  The others go through FillPatchSingleLevel one by one.
+	//
+	Array<int>                  direct(N,0);
+	Array<FabArray<FArrayBox>*> fb_fas;
+	Array<int>                  fb_scomp, fb_ncomp;
+
+	for (int k = 0; k < N; ++k)
 	{
+	    const FillPatchPiece&   p   = pieces[k];
+	    const PArray<MultiFab>& smf = *p.fmf;
+
+	    BL_ASSERT(p.scomp+p.ncomp <= smf[0].nComp());
+	    BL_ASSERT(p.dcomp+p.ncomp <= mf.nComp());
+	    BL_ASSERT(smf.size() == p.ft->size());
+	    BL_ASSERT(smf.size() != 0);
+
+	    if ((smf.size() == 1 || smf.size() == 2) &&
+		mf.boxArray()        == smf[0].boxArray() &&
+		mf.DistributionMap() == smf[0].DistributionMap())
+	    {
+		direct[k] = 1;
+		fb_fas  .push_back(&mf);
+		fb_scomp.push_back(p.dcomp);
+		fb_ncomp.push_back(p.ncomp);
+	    }
+	}
+
+	if (!fb_fas.empty())
+	{
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	    for (MFIter mfi(mf,true); mfi.isValid(); ++mfi)
+	    {
+		const Box& bx = mfi.tilebox();
+
+		for (int k = 0; k < N; ++k)
+		{
+		    if (!direct[k]) continue;
+
+		    const FillPatchPiece&    p     = pieces[k];
+		    const PArray<MultiFab>&  smf   = *p.fmf;
+		    const std::vector<Real>& stime = *p.ft;
+
+		    if (smf.size() == 1)
+		    {
+			if (&smf[0] != &mf)
+			    mf[mfi].copy(smf[0][mfi],bx,p.scomp,bx,p.dcomp,p.ncomp);
+		    }
+		    else
+		    {
+			mf[mfi].linInterp(smf[0][mfi],
+					  p.scomp,
+					  smf[1][mfi],
+					  p.scomp,
+					  stime[0],
+					  stime[1],
+					  time,
+					  bx,
+					  p.dcomp,
+					  p.ncomp);
+		    }
+		}
+	    }
+
+	    MultiFab::FillBoundaryFused(fb_fas, fb_scomp, fb_ncomp, geom.periodicity());
+	}
+
+	for (int k = 0; k < N; ++k)
+	{
+	    const FillPatchPiece& p = pieces[k];
+
+	    if (direct[k]) {
+		p.fbc->FillBoundary(mf, p.dcomp, p.ncomp, time);
+	    } else {
+		FillPatchSingleLevel(mf, time, *p.fmf, *p.ft, p.scomp, p.dcomp, p.ncomp, geom, *p.fbc);
+	    }
+	}
+    }
+
+    void FillPatchTwoLevels (MultiFab& mf, Real time,
+			     const Array<FillPatchPiece>& pieces,
+			     const Geometry& cgeom, const Geometry& fgeom,
+			     const IntVect& ratio)
+    {
+	BL_PROFILE("FillPatchTwoLevels(pieces)");
+
+	const int N     = pieces.size();
+	const int ngrow = mf.nGrow();
+
+	Box fdomain = fgeom.Domain();
+	fdomain.convert(mf.boxArray().ixType());
+	Box fdomain_g(fdomain);
+	for (int i = 0; i < BL_SPACEDIM; ++i) {
+	    if (fgeom.isPeriodic(i)) {
+		fdomain_g.grow(i,ngrow);
+	    }
+	}
+	//
+	// Group the pieces that need coarse data by the coarse patches they
+	// need.  These depend on the interpolater and the fine data layout.
+	//
+	typedef std::pair<Interpolater*,FabArrayBase::BDKey> GroupKey;
+
+	std::map<GroupKey,Array<int> > groups;
+
+	for (int k = 0; k < N; ++k)
+	{
+	    const MultiFab& fmf0 = (*pieces[k].fmf)[0];
+
+	    if (ngrow > 0 || mf.getBDKey() != fmf0.getBDKey())
+		groups[GroupKey(pieces[k].mapper,fmf0.getBDKey())].push_back(k);
+	}
+
+	for (std::map<GroupKey,Array<int> >::const_iterator git = groups.begin(), End = groups.end();
+	     git != End;
+	     ++git)
+	{
+	    Interpolater*     mapper = git->first.first;
+	    const Array<int>& ks     = git->second;
+	    const int         NG     = ks.size();
+
 	    const InterpolaterBoxCoarsener& coarsener = mapper->BoxCoarsener(ratio);
-	    
-	    Box fdomain = fgeom.Domain();
-	    fdomain.convert(mf.boxArray().ixType());
-	    Box fdomain_g(fdomain);
-	    for (int i = 0; i < BL_SPACEDIM; ++i) {
-		if (fgeom.isPeriodic(i)) {
-		    fdomain_g.grow(i,ngrow);
+
+	    const FabArrayBase::FPinfo& fpc = FabArrayBase::TheFPinfo((*pieces[ks[0]].fmf)[0], mf,
+								      fdomain_g, ngrow, coarsener);
+
+	    if (fpc.ba_crse_patch.empty()) continue;
+	    //
+	    // Piece ks[j] has components [pcomp[j],pcomp[j+1]) of the coarse patches.
+	    //
+	    Array<int> pcomp(NG+1,0);
+	    for (int j = 0; j < NG; ++j)
+		pcomp[j+1] = pcomp[j] + pieces[ks[j]].ncomp;
+
+	    MultiFab mf_crse_patch(fpc.ba_crse_patch, pcomp[NG], 0, fpc.dm_crse_patch);
+	    //
+	    // Interpolate in time on the coarse grids where needed.
+	    //
+	    PArray<MultiFab>                  raii(PArrayManage);
+	    Array<const FabArray<FArrayBox>*> cp_src(NG);
+	    Array<int>                        cp_scomp(NG);
+
+	    for (int j = 0; j < NG; ++j)
+	    {
+		const FillPatchPiece&    p   = pieces[ks[j]];
+		const PArray<MultiFab>&  cmf = *p.cmf;
+		const std::vector<Real>& ct  = *p.ct;
+
+		BL_ASSERT(cmf.size() == ct.size());
+		BL_ASSERT(cmf.size() != 0);
+
+		if (cmf.size() == 1)
+		{
+		    cp_src  [j] = &cmf[0];
+		    cp_scomp[j] = p.scomp;
+		}
+		else if (cmf.size() == 2)
+		{
+		    BL_ASSERT(cmf[0].boxArray() == cmf[1].boxArray());
+
+		    MultiFab* dmf = raii.push_back(new MultiFab(cmf[0].boxArray(), p.ncomp, 0,
+								cmf[0].DistributionMap()));
+
+		    TimeInterpForCopy(*dmf, 0, cmf, ct, p.scomp, p.ncomp, time,
+				      fpc.ba_crse_patch, 0, cgeom.periodicity());
+
+		    cp_src  [j] = dmf;
+		    cp_scomp[j] = 0;
+		}
+		else
+		{
+		    BoxLib::Abort("FillPatchTwoLevels: high-order interpolation in time not implemented yet");
 		}
 	    }
-	    
-	    const FabArrayBase::FPinfo& fpc = FabArrayBase::TheFPinfo(fmf[0], mf, fdomain_g, ngrow, coarsener);
+	    //
+	    // One copy into the coarse patches for each coarse data layout.
+	    //
+	    std::map<FabArrayBase::BDKey,Array<int> > by_src;
+	    for (int j = 0; j < NG; ++j)
+		by_src[cp_src[j]->getBDKey()].push_back(j);
 
-	    if ( ! fpc.ba_crse_patch.empty())
+	    for (std::map<FabArrayBase::BDKey,Array<int> >::const_iterator sit = by_src.begin(),
+		     sEnd = by_src.end();
+		 sit != sEnd;
+		 ++sit)
 	    {
-		MultiFab mf_crse_patch(fpc.ba_crse_patch, ncomp, 0, fpc.dm_crse_patch);
-		
-		FillPatchSingleLevel(mf_crse_patch, time, cmf, ct, scomp, 0, ncomp, cgeom, cbc);
-		
-		int idummy1=0, idummy2=0;
-		bool cc = fpc.ba_crse_patch.ixType().cellCentered();
-#ifdef _OPENMP
-#pragma omp parallel if (cc)
-#endif
-		for (MFIter mfi(mf_crse_patch); mfi.isValid(); ++mfi)
+		const Array<int>& js = sit->second;
+		const int         NS = js.size();
+
+		Array<FabArray<FArrayBox>*>       dst(NS, &mf_crse_patch);
+		Array<const FabArray<FArrayBox>*> src(NS);
+		Array<int>                        sc(NS), dc(NS), nc(NS);
+
+		for (int i = 0; i < NS; ++i)
 		{
-		    int li = mfi.LocalIndex();
-		    int gi = fpc.dst_idxs[li];		
-		    const Box& dbx = fpc.dst_boxes[li];
-		    
-		    Array<BCRec> bcr(ncomp);
-		    BoxLib::setBC(dbx,fdomain,scomp,0,ncomp,bcs,bcr);
-		    
-		    mapper->interp(mf_crse_patch[mfi],
-				   0,
-				   mf[gi],
-				   dcomp,
-				   ncomp,
-				   dbx,
-				   ratio,
-				   cgeom,
-				   fgeom,
-				   bcr,
-				   idummy1, idummy2);
+		    const int j = js[i];
+		    src[i] = cp_src[j];
+		    sc [i] = cp_scomp[j];
+		    dc [i] = pcomp[j];
+		    nc [i] = pieces[ks[j]].ncomp;
 		}
+
+		MultiFab::copyFused(dst, src, sc, dc, nc, 0, 0, cgeom.periodicity());
 	    }
+
+	    for (int j = 0; j < NG; ++j)
+	    {
+		const FillPatchPiece& p = pieces[ks[j]];
+		p.cbc->FillBoundary(mf_crse_patch, pcomp[j], p.ncomp, time);
+	    }
+
+	    const bool cc = fpc.ba_crse_patch.ixType().cellCentered();
+
+	    std::vector<InterpTile> tiles;
+	    for (MFIter mfi(mf_crse_patch); mfi.isValid(); ++mfi)
+	    {
+		const int li = mfi.LocalIndex();
+		MakeInterpTiles(tiles, mfi.index(), fpc.dst_idxs[li], fpc.dst_boxes[li], ratio);
+	    }
+
+	    InterpTiles(tiles, mf_crse_patch, mf, mapper, pieces, ks, pcomp,
+			fdomain, ratio, cgeom, fgeom, cc);
 	}
 
-	FillPatchSingleLevel(mf, time, fmf, ft, scomp, dcomp, ncomp, fgeom, fbc);
+	FillPatchSingleLevel(mf, time, pieces, fgeom);
     }
 
     void InterpFromCoarseLevel (MultiFab& mf, Real time, const MultiFab& cmf, 
@@ -215,32 +599,21 @@ namespace BoxLib
 
 	cbc.FillBoundary(mf_crse_patch, 0, ncomp, time);
 
-	int idummy1=0, idummy2=0;
+	Array<FillPatchPiece> pieces(1);
+	pieces[0].scomp = scomp;
+	pieces[0].dcomp = dcomp;
+	pieces[0].ncomp = ncomp;
+	pieces[0].bcs   = &bcs;
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
+	std::vector<InterpTile> tiles;
 	for (MFIter mfi(mf_crse_patch); mfi.isValid(); ++mfi)
 	{
-	    FArrayBox& dfab = mf[mfi];
-	    const Box& dbx = dfab.box() & fdomain_g;
-
-	    Array<BCRec> bcr(ncomp);
-	    BoxLib::setBC(dbx,fdomain,scomp,0,ncomp,bcs,bcr);
-	    
-	    mapper->interp(mf_crse_patch[mfi],
-			   0,
-			   mf[mfi],
-			   dcomp,
-			   ncomp,
-			   dbx,
-			   ratio,
-			   cgeom,
-			   fgeom,
-			   bcr,
-			   idummy1, idummy2);	    
+	    MakeInterpTiles(tiles, mfi.index(), mfi.index(), mf[mfi].box() & fdomain_g, ratio);
 	}
 
+	InterpTiles(tiles, mf_crse_patch, mf, mapper, pieces, Array<int>(1,0), Array<int>(1,0),
+		    fdomain, ratio, cgeom, fgeom, true);
+
 	fbc.FillBoundary(mf, dcomp, ncomp, time);
     }
 }
@@ -9,7 +9,15 @@
 
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 FluxRegister::FluxRegister ()
+    :
+    reflux_mf(0),
+    reflux_vol(0),
+    reflux_own_vol(0)
 {
     fine_level = ncomp = -1;
     ratio = IntVect::TheUnitVector();
@@ -20,6 +28,10 @@ FluxRegister::FluxRegister (const BoxArray& fine_boxes,
                             const IntVect&  ref_ratio,
                             int             fine_lev,
                             int             nvar)
+    :
+    reflux_mf(0),
+    reflux_vol(0),
+    reflux_own_vol(0)
 {
     define(fine_boxes,ref_ratio,fine_lev,nvar);
 }
@@ -29,6 +41,10 @@ FluxRegister::FluxRegister (const BoxArray&            fine_boxes,
                             int                        fine_lev,
                             int                        nvar,
                             const DistributionMapping& dm)
+    :
+    reflux_mf(0),
+    reflux_vol(0),
+    reflux_own_vol(0)
 {
     define(fine_boxes,ref_ratio,fine_lev,nvar,dm);
 }
@@ -72,6 +88,8 @@ FluxRegister::define (const BoxArray& fine_boxes,
     BL_ASSERT(fine_boxes.isDisjoint());
     BL_ASSERT(grids.size() == 0);
 
+    CrseInit_finish();
+
     ratio      = ref_ratio;
     fine_level = fine_lev;
     ncomp      = nvar;
@@ -103,6 +121,8 @@ FluxRegister::define (const BoxArray&            fine_boxes,
     BL_ASSERT(fine_boxes.isDisjoint());
     BL_ASSERT(grids.size() == 0);
 
+    CrseInit_finish();
+
     ratio      = ref_ratio;
     fine_level = fine_lev;
     ncomp      = nvar;
@@ -124,11 +144,23 @@ FluxRegister::define (const BoxArray&            fine_boxes,
     }
 }
 
-FluxRegister::~FluxRegister () {}
+FluxRegister::~FluxRegister ()
+{
+    CrseInit_finish();
+    delete reflux_own_vol;
+}
+
+void
+FluxRegister::finishPending () const
+{
+    const_cast<FluxRegister*>(this)->CrseInit_finish();
+}
 
 Real
 FluxRegister::SumReg (int comp) const
 {
+    const_cast<FluxRegister*>(this)->CrseInit_finish();
+
     Real sum = 0.0;
 
     for (int dir = 0; dir < BL_SPACEDIM; dir++)
@@ -159,12 +191,50 @@ FluxRegister::CrseInit (const MultiFab& mflx,
                         int             numcomp,
                         Real            mult,
                         FrOp            op)
+{
+    CrseInit_nowait(mflx,area,dir,srccomp,destcomp,numcomp,mult,op);
+
+    CrseInitFinish(Orientation(dir,Orientation::low));
+    CrseInitFinish(Orientation(dir,Orientation::high));
+}
+
+void
+FluxRegister::CrseInit (const MultiFab& mflx,
+                        int             dir,
+                        int             srccomp,
+                        int             destcomp,
+                        int             numcomp,
+                        Real            mult,
+                        FrOp            op)
+{
+    BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= mflx.nComp());
+    BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
+
+    MultiFab area(mflx.boxArray(), 1, mflx.nGrow());
+
+    area.setVal(1, 0, 1, area.nGrow());
+
+    CrseInit(mflx,area,dir,srccomp,destcomp,numcomp,mult,op);
+}
+
+void
+FluxRegister::CrseInit_nowait (const MultiFab& mflx,
+                               const MultiFab& area,
+                               int             dir,
+                               int             srccomp,
+                               int             destcomp,
+                               int             numcomp,
+                               Real            mult,
+                               FrOp            op)
 {
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= mflx.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
 
     const Orientation face_lo(dir,Orientation::low);
     const Orientation face_hi(dir,Orientation::high);
+
+    CrseInitFinish(face_lo);
+    CrseInitFinish(face_hi);
  
     MultiFab mf(mflx.boxArray(),numcomp,0);
 
@@ -187,35 +257,36 @@ FluxRegister::CrseInit (const MultiFab& mflx,
     {
         const Orientation face = ((pass == 0) ? face_lo : face_hi);
 
+        CrseInitComm& cic = crse_init_comm[face];
+
         if (op == FluxRegister::COPY)
         {
-            bndry[face].copyFrom(mf,0,0,destcomp,numcomp);
+            bndry[face].copyFrom_nowait(mf,0,0,destcomp,numcomp);
         }
         else
         {
-            FabSet fs(bndry[face].boxArray(),numcomp);
-
-            fs.setVal(0);
+            cic.fs = new FabSet(bndry[face].boxArray(),numcomp);
 
-            fs.copyFrom(mf,0,0,0,numcomp);
+            cic.fs->setVal(0);
 
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-            for (FabSetIter mfi(fs); mfi.isValid(); ++mfi)
-                bndry[face][mfi].plus(fs[mfi],0,destcomp,numcomp);
+            cic.fs->copyFrom_nowait(mf,0,0,0,numcomp);
         }
+
+        cic.pending  = true;
+        cic.op       = op;
+        cic.destcomp = destcomp;
+        cic.numcomp  = numcomp;
     }
 }
 
 void
-FluxRegister::CrseInit (const MultiFab& mflx,
-                        int             dir,
-                        int             srccomp,
-                        int             destcomp,
-                        int             numcomp,
-                        Real            mult,
-                        FrOp            op)
+FluxRegister::CrseInit_nowait (const MultiFab& mflx,
+                               int             dir,
+                               int             srccomp,
+                               int             destcomp,
+                               int             numcomp,
+                               Real            mult,
+                               FrOp            op)
 {
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= mflx.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
@@ -224,7 +295,59 @@ FluxRegister::CrseInit (const MultiFab& mflx,
 
     area.setVal(1, 0, 1, area.nGrow());
 
-    CrseInit(mflx,area,dir,srccomp,destcomp,numcomp,mult,op);
+    CrseInit_nowait(mflx,area,dir,srccomp,destcomp,numcomp,mult,op);
+}
+
+void
+FluxRegister::CrseInit_finish ()
+{
+    for (OrientationIter fi; fi; ++fi)
+        CrseInitFinish(fi());
+}
+
+void
+FluxRegister::CrseInitFinish (const Orientation& face)
+{
+    CrseInitComm& cic = crse_init_comm[face];
+
+    if (!cic.pending) return;
+
+#ifdef _OPENMP
+    if (omp_in_parallel())
+        BoxLib::Abort("FluxRegister: call CrseInit_finish() before an OpenMP parallel region");
+#endif
+
+    if (cic.op == FluxRegister::COPY)
+    {
+        bndry[face].copyFrom_finish();
+    }
+    else
+    {
+        FabSet& fs = *cic.fs;
+
+        fs.copyFrom_finish();
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (FabSetIter mfi(fs); mfi.isValid(); ++mfi)
+            bndry[face][mfi].plus(fs[mfi],0,cic.destcomp,cic.numcomp);
+
+        delete cic.fs;
+        cic.fs = 0;
+    }
+
+    cic.pending = false;
+}
+
+bool
+FluxRegister::CrseInitCopyPending (int dir) const
+{
+    const CrseInitComm& lo = crse_init_comm[Orientation(dir,Orientation::low)];
+    const CrseInitComm& hi = crse_init_comm[Orientation(dir,Orientation::high)];
+
+    return (lo.pending && lo.op == FluxRegister::COPY)
+        || (hi.pending && hi.op == FluxRegister::COPY);
 }
 
 void
@@ -235,6 +358,12 @@ FluxRegister::FineAdd (const MultiFab& mflx,
                        int             numcomp,
                        Real            mult)
 {
+    if (CrseInitCopyPending(dir))
+    {
+        CrseInitFinish(Orientation(dir,Orientation::low));
+        CrseInitFinish(Orientation(dir,Orientation::high));
+    }
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -254,6 +383,12 @@ FluxRegister::FineAdd (const MultiFab& mflx,
                        int             numcomp,
                        Real            mult)
 {
+    if (CrseInitCopyPending(dir))
+    {
+        CrseInitFinish(Orientation(dir,Orientation::low));
+        CrseInitFinish(Orientation(dir,Orientation::high));
+    }
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -276,6 +411,9 @@ FluxRegister::FineAdd (const FArrayBox& flux,
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= flux.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
 
+    if (CrseInitCopyPending(dir))
+        BoxLib::Abort("FluxRegister::FineAdd: call CrseInit_finish() before adding FArrayBoxes");
+
     const Box&  flxbox = flux.box();
     const int*  flo    = flxbox.loVect();
     const int*  fhi    = flxbox.hiVect();
@@ -320,6 +458,9 @@ FluxRegister::FineAdd (const FArrayBox& flux,
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= flux.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= ncomp);
 
+    if (CrseInitCopyPending(dir))
+        BoxLib::Abort("FluxRegister::FineAdd: call CrseInit_finish() before adding FArrayBoxes");
+
     const Real* area_dat = area.dataPtr();
     const int*  alo      = area.loVect();
     const int*  ahi      = area.hiVect();
@@ -367,16 +508,102 @@ FluxRegister::Reflux (MultiFab&       mf,
 {
     BL_PROFILE("FluxRegister::Reflux()");
 
+    Reflux_nowait(mf,volume,scale,scomp,dcomp,ncomp,geom);
+    Reflux_finish();
+}
+
+void 
+FluxRegister::Reflux (MultiFab&       mf,
+		      Real            scale,
+		      int             scomp,
+		      int             dcomp,
+		      int             ncomp,
+		      const Geometry& geom)
+{
+    const Real* dx = geom.CellSize();
+    
+    MultiFab volume(mf.boxArray(), 1, mf.nGrow());
+    
+    volume.setVal(D_TERM(dx[0],*dx[1],*dx[2]), 0, 1, mf.nGrow());
+
+    Reflux(mf,volume,scale,scomp,dcomp,ncomp,geom);
+}
+
+void 
+FluxRegister::Reflux_nowait (MultiFab&       mf,
+			     const MultiFab& volume,
+			     Real            scale,
+			     int             scomp,
+			     int             dcomp,
+			     int             ncomp,
+			     const Geometry& geom)
+{
+    BL_PROFILE("FluxRegister::Reflux_nowait()");
+
+    BL_ASSERT(reflux_mf == 0);
+
+    CrseInit_finish();
+
+    reflux_flux.resize(2*BL_SPACEDIM, PArrayManage);
+
+    for (OrientationIter fi; fi; ++fi)
+    {
+	const Orientation& face = fi();
+
+	MultiFab* flux = new MultiFab(mf.boxArray(), ncomp, 0, Fab_allocate,
+				      IntVect::TheDimensionVector(face.coordDir()));
+	flux->setVal(0.0);
+
+	bndry[face].copyTo_nowait(*flux, 0, scomp, 0, ncomp, geom.periodicity());
+
+	reflux_flux.set(face, flux);
+    }
+
+    reflux_mf    = &mf;
+    reflux_vol   = &volume;
+    reflux_scale = scale;
+    reflux_dcomp = dcomp;
+    reflux_ncomp = ncomp;
+}
+
+void 
+FluxRegister::Reflux_nowait (MultiFab&       mf,
+			     Real            scale,
+			     int             scomp,
+			     int             dcomp,
+			     int             ncomp,
+			     const Geometry& geom)
+{
+    const Real* dx = geom.CellSize();
+    
+    MultiFab* volume = new MultiFab(mf.boxArray(), 1, mf.nGrow());
+    
+    volume->setVal(D_TERM(dx[0],*dx[1],*dx[2]), 0, 1, mf.nGrow());
+
+    Reflux_nowait(mf,*volume,scale,scomp,dcomp,ncomp,geom);
+
+    reflux_own_vol = volume;
+}
+
+void 
+FluxRegister::Reflux_finish ()
+{
+    if (reflux_mf == 0) return;
+
+    BL_PROFILE("FluxRegister::Reflux_finish()");
+
+    MultiFab&       mf     = *reflux_mf;
+    const MultiFab& volume = *reflux_vol;
+
     for (OrientationIter fi; fi; ++fi)
     {
 	const Orientation& face = fi();
 	int idir = face.coordDir();
 	int islo = face.isLow();
 
-	MultiFab flux(mf.boxArray(), ncomp, 0, Fab_allocate, IntVect::TheDimensionVector(idir));
-	flux.setVal(0.0);
+	MultiFab& flux = reflux_flux[face];
 
-	bndry[face].copyTo(flux, 0, scomp, 0, ncomp, geom.periodicity());
+	flux.copy_finish();
 
 #ifdef _OPENMP
 #pragma omp parallel
@@ -395,35 +622,27 @@ FluxRegister::Reflux (MultiFab&       mf,
 	    const Box& vbox = vfab.box();
 
 	    FORT_FRREFLUX(bx.loVect(), bx.hiVect(),
-			  sfab.dataPtr(dcomp), sbox.loVect(), sbox.hiVect(),
+			  sfab.dataPtr(reflux_dcomp), sbox.loVect(), sbox.hiVect(),
 			  ffab.dataPtr(     ), fbox.loVect(), fbox.hiVect(),
 			  vfab.dataPtr(     ), vfab.loVect(), vbox.hiVect(),
-			  &ncomp, &scale, &idir, &islo);
-			  
+			  &reflux_ncomp, &reflux_scale, &idir, &islo);
 	}
     }
-}
 
-void 
-FluxRegister::Reflux (MultiFab&       mf,
-		      Real            scale,
-		      int             scomp,
-		      int             dcomp,
-		      int             ncomp,
-		      const Geometry& geom)
-{
-    const Real* dx = geom.CellSize();
-    
-    MultiFab volume(mf.boxArray(), 1, mf.nGrow());
-    
-    volume.setVal(D_TERM(dx[0],*dx[1],*dx[2]), 0, 1, mf.nGrow());
+    reflux_flux.clear();
 
-    Reflux(mf,volume,scale,scomp,dcomp,ncomp,geom);
+    delete reflux_own_vol;
+
+    reflux_own_vol = 0;
+    reflux_vol     = 0;
+    reflux_mf      = 0;
 }
 
 void
 FluxRegister::ClearInternalBorders (const Geometry& geom)
 {
+    CrseInit_finish();
+
     int ncomp = this->nComp();
     const Box& domain = geom.Domain();
     
@@ -483,6 +702,8 @@ FluxRegister::ClearInternalBorders (const Geometry& geom)
 void
 FluxRegister::write (const std::string& name, std::ostream& os) const
 {
+    const_cast<FluxRegister*>(this)->CrseInit_finish();
+
     if (ParallelDescriptor::IOProcessor())
     {
         os << ratio      << '\n';
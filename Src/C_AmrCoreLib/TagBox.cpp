@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <climits>
+#include <map>
 
 #include <TagBox.H>
 #include <Geometry.H>
@@ -585,6 +586,227 @@ TagBoxArray::collate (std::vector<IntVect>& TheGlobalCollateSpace) const
 #endif
 }
 
+void
+TagBoxArray::collateOwned (std::vector<IntVect>& TheLocalCollateSpace,
+                           BoxList&              region) const
+{
+    BL_PROFILE("TagBoxArray::collateOwned()");
+
+    const int MyProc = ParallelDescriptor::MyProc();
+    const int NProcs = ParallelDescriptor::NProcs();
+
+    BoxArray gba(boxArray());
+
+    gba.grow(n_grow);
+
+    TheLocalCollateSpace.clear();
+    //
+    // The cells we own, and the tags that belong to boxes on other CPUs.
+    //
+    BoxList owned(gba.ixType());
+
+    std::map< int,std::vector<IntVect> > not_ours;
+
+    std::vector<IntVect>              ar;
+    std::vector< std::pair<int,Box> > isects, lower;
+
+    for (MFIter fai(*this); fai.isValid(); ++fai)
+    {
+        const int  i  = fai.index();
+        const Box& bx = gba[i];
+        //
+        // The parts of this box also in lower-numbered boxes aren't ours.
+        //
+        gba.intersections(bx,isects);
+
+        lower.clear();
+
+        BoxList bl_lower(bx.ixType());
+
+        for (int k = 0, N = isects.size(); k < N; k++)
+        {
+            if (isects[k].first < i)
+            {
+                lower.push_back(isects[k]);
+                bl_lower.push_back(isects[k].second);
+            }
+        }
+
+        BoxList mine = BoxLib::complementIn(bx,bl_lower);
+
+        owned.catenate(mine);
+
+        const TagBox& tb = get(fai);
+
+        ar.resize(tb.numTags());
+
+        tb.collate(ar,0);
+
+        for (int n = 0, N = ar.size(); n < N; n++)
+        {
+            int j = i;
+
+            for (int k = 0, K = lower.size(); k < K; k++)
+                if (lower[k].first < j && lower[k].second.contains(ar[n]))
+                    j = lower[k].first;
+
+            const int who = (j == i) ? MyProc : distributionMap[j];
+
+            if (who == MyProc)
+                TheLocalCollateSpace.push_back(ar[n]);
+            else
+                not_ours[who].push_back(ar[n]);
+        }
+    }
+
+#if BL_USE_MPI
+    if (NProcs > 1)
+    {
+        //
+        // Send the tags that aren't ours to their owners.
+        //
+        BL_ASSERT(sizeof(IntVect) == BL_SPACEDIM * sizeof(int));
+
+        Array<int> Snds(NProcs,0), Rcvs(NProcs,0);
+
+        for (std::map< int,std::vector<IntVect> >::const_iterator it = not_ours.begin();
+             it != not_ours.end();
+             ++it)
+        {
+            Snds[it->first] = it->second.size();
+        }
+
+        BL_MPI_REQUIRE( MPI_Alltoall(Snds.dataPtr(),
+                                     1,
+                                     ParallelDescriptor::Mpi_typemap<int>::type(),
+                                     Rcvs.dataPtr(),
+                                     1,
+                                     ParallelDescriptor::Mpi_typemap<int>::type(),
+                                     ParallelDescriptor::Communicator()) );
+
+        const int  SeqNum = ParallelDescriptor::SeqNum();
+        const long NLocal = TheLocalCollateSpace.size();
+
+        long NumRcvs = 0;
+
+        for (int i = 0; i < NProcs; i++)
+            NumRcvs += Rcvs[i];
+
+        TheLocalCollateSpace.resize(NLocal + NumRcvs);
+
+        Array<MPI_Request> reqs;
+
+        for (long i = 0, Idx = NLocal; i < NProcs; Idx += Rcvs[i], i++)
+        {
+            if (Rcvs[i] > 0)
+                reqs.push_back(ParallelDescriptor::Arecv(TheLocalCollateSpace[Idx].getVect(),
+                                                         Rcvs[i]*BL_SPACEDIM,
+                                                         i,SeqNum).req());
+        }
+
+        for (std::map< int,std::vector<IntVect> >::const_iterator it = not_ours.begin();
+             it != not_ours.end();
+             ++it)
+        {
+            reqs.push_back(ParallelDescriptor::Asend(it->second[0].getVect(),
+                                                     it->second.size()*BL_SPACEDIM,
+                                                     it->first,SeqNum).req());
+        }
+
+        if (!reqs.empty())
+        {
+            Array<MPI_Status> stats(reqs.size());
+
+            BL_MPI_REQUIRE( MPI_Waitall(reqs.size(), reqs.dataPtr(), stats.dataPtr()) );
+        }
+    }
+#endif
+    //
+    // The minimal box around our tags.
+    //
+    Box mbx;
+
+    if (!TheLocalCollateSpace.empty())
+    {
+        //
+        // Remove duplicate IntVects.
+        //
+	std::set<IntVect, IntVect::Compare> tmp (TheLocalCollateSpace.begin(),
+						 TheLocalCollateSpace.end());
+	TheLocalCollateSpace.assign( tmp.begin(), tmp.end() );
+
+        IntVect lo = TheLocalCollateSpace[0], hi = lo;
+
+        for (long n = 1, N = TheLocalCollateSpace.size(); n < N; n++)
+        {
+            lo.min(TheLocalCollateSpace[n]);
+            hi.max(TheLocalCollateSpace[n]);
+        }
+
+        mbx = Box(lo,hi);
+    }
+    //
+    // Our clusters may cover the cells we own, plus the cells in no box at
+    // all that aren't in the minimal box of a lower-numbered CPU's tags.
+    // The clusters of different CPUs then can't overlap.
+    //
+    BoxList lower_mbx(gba.ixType());
+
+#if BL_USE_MPI
+    if (NProcs > 1)
+    {
+        Array<int> sendbuf(2*BL_SPACEDIM), recvbuf(2*BL_SPACEDIM*NProcs);
+
+        for (int d = 0; d < BL_SPACEDIM; d++)
+        {
+            sendbuf[d]             = mbx.smallEnd(d);
+            sendbuf[d+BL_SPACEDIM] = mbx.bigEnd(d);
+        }
+
+        BL_MPI_REQUIRE( MPI_Allgather(sendbuf.dataPtr(),
+                                      2*BL_SPACEDIM,
+                                      ParallelDescriptor::Mpi_typemap<int>::type(),
+                                      recvbuf.dataPtr(),
+                                      2*BL_SPACEDIM,
+                                      ParallelDescriptor::Mpi_typemap<int>::type(),
+                                      ParallelDescriptor::Communicator()) );
+
+        for (int i = 0; i < MyProc && mbx.ok(); i++)
+        {
+            const Box bx = Box(IntVect(&recvbuf[2*BL_SPACEDIM*i]),
+                               IntVect(&recvbuf[2*BL_SPACEDIM*i+BL_SPACEDIM])) & mbx;
+            if (bx.ok())
+                lower_mbx.push_back(bx);
+        }
+    }
+#endif
+
+    region.clear();
+
+    if (mbx.ok())
+    {
+        region = BoxLib::intersect(owned,mbx);
+
+        BoxList bl_free = BoxLib::complementIn(mbx,lower_mbx);
+
+        for (BoxList::const_iterator it = bl_free.begin(), End = bl_free.end(); it != End; ++it)
+        {
+            gba.intersections(*it,isects);
+
+            BoxList bl_covered(gba.ixType());
+
+            for (int k = 0, N = isects.size(); k < N; k++)
+                bl_covered.push_back(isects[k].second);
+
+            BoxList uncovered = BoxLib::complementIn(*it,bl_covered);
+
+            region.catenate(uncovered);
+        }
+
+        region.simplify();
+    }
+}
+
 void
 TagBoxArray::setVal (const BoxList& bl,
                      TagBox::TagVal val)
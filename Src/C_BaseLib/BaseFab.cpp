@@ -7,9 +7,12 @@
 #include <BaseFab.H>
 #include <BArena.H>
 #include <CArena.H>
+#include <PArena.H>
+#include <ParmParse.H>
 
 #if !(defined(BL_NO_FORT) || defined(WIN32))
 #include <BaseFab_f.H>
+#define BL_FORT_FAB_KERNELS
 #endif
 
 #ifdef BL_MEM_PROFILING
@@ -162,7 +165,462 @@ BoxLib::The_Arena ()
     return the_arena;
 }
 
-#if !(defined(BL_NO_FORT) || defined(WIN32))
+void
+BoxLib::InitializeArena ()
+{
+    BL_ASSERT(the_arena != 0);
+
+    std::string arena_type;
+    {
+        ParmParse pp("boxlib");
+        if (!pp.query("arena", arena_type))
+            return;
+    }
+
+    Arena* new_arena = 0;
+
+    if (arena_type == "basic")
+    {
+        if (dynamic_cast<BArena*>(the_arena) == 0)
+            new_arena = new BArena;
+    }
+    else if (arena_type == "coalescing")
+    {
+        if (dynamic_cast<CArena*>(the_arena) == 0)
+            new_arena = new CArena;
+    }
+    else if (arena_type == "pooled")
+    {
+        if (dynamic_cast<PArena*>(the_arena) == 0)
+        {
+            PArena* parena = new PArena;
+#ifdef BL_MEM_PROFILING
+            MemProfiler::add("PArena", std::function<MemProfiler::MemInfo()>
+                             ([parena] () -> MemProfiler::MemInfo {
+                                 return {parena->heap_space_used(),
+                                         parena->heap_space_hwm()};
+                             }));
+#endif
+            new_arena = parena;
+        }
+    }
+    else
+    {
+        BoxLib::Abort("BoxLib::InitializeArena: boxlib.arena must be basic, coalescing or pooled");
+    }
+
+    if (new_arena != 0)
+    {
+        //
+        // Blocks must be freed by the Arena that allocated them.
+        //
+        if (BoxLib::TotalBytesAllocatedInFabs() != 0)
+            BoxLib::Abort("BoxLib::InitializeArena: FABs were allocated before boxlib.arena was set");
+
+        delete the_arena;
+        the_arena = new_arena;
+    }
+}
+
+void
+BoxLib::ReleaseArenaCache ()
+{
+    if (PArena* parena = dynamic_cast<PArena*>(the_arena))
+        parena->release();
+}
+
+
+//
+// C++ versions of the hot BaseFab<Real> kernels.  The loop nest is fixed
+// at compile time by BL_SPACEDIM with the unit-stride direction innermost,
+// single-component calls get their own instantiation, and when every
+// operand is contiguous over the box the rows are fused into one loop.
+// The Fortran versions in BaseFab_nd.f90 remain selectable at run time.
+//
+#if defined(_OPENMP) && (_OPENMP >= 201307)
+#define BL_FAB_PRAGMA(x) _Pragma(#x)
+#define BL_FAB_SIMD BL_FAB_PRAGMA(omp simd)
+#define BL_FAB_SIMD_REDUCTION(r) BL_FAB_PRAGMA(omp simd reduction(r))
+#else
+#define BL_FAB_SIMD
+#define BL_FAB_SIMD_REDUCTION(r)
+#endif
+
+#if defined(__GNUC__) || defined(__INTEL_COMPILER)
+#define BL_FAB_RESTRICT __restrict__
+#else
+#define BL_FAB_RESTRICT
+#endif
+
+namespace
+{
+    bool cxx_kernels = true;
+    //
+    // Points at cell bx.smallEnd() of component comp of a FAB defined on fbx.
+    //
+    template <class T>
+    struct FabPtr
+    {
+        FabPtr (T* p, const Box& fbx, const Box& bx, int comp)
+        {
+            const IntVect flen = fbx.size();
+            const IntVect off  = bx.smallEnd() - fbx.smallEnd();
+#if (BL_SPACEDIM == 1)
+            jstride = 0;
+            kstride = 0;
+#elif (BL_SPACEDIM == 2)
+            jstride = flen[0];
+            kstride = 0;
+#else
+            jstride = flen[0];
+            kstride = jstride*flen[1];
+#endif
+            nstride = D_TERM(long(flen[0]), *flen[1], *flen[2]);
+            p0 = p + comp*nstride + D_TERM(off[0], + off[1]*jstride, + off[2]*kstride);
+        }
+
+        T* row (int j, int k, int n) const { return p0 + n*nstride + j*jstride + k*kstride; }
+        //
+        // Are the rows of bx (of length len[0]) adjacent in memory?
+        //
+        bool contiguous (const IntVect& len) const
+        {
+            return D_TERM(true, && jstride == len[0], && kstride == jstride*len[1]);
+        }
+        //
+        // Are the components adjacent as well?
+        //
+        bool contiguous (long npts) const { return nstride == npts; }
+
+        T*   p0;
+        long jstride, kstride, nstride;
+    };
+
+    struct OneFab
+    {
+        OneFab (const Real* p, const Box& fbx, const Box& bx, int comp)
+            : a(p,fbx,bx,comp) {}
+        template <class L> bool contiguous (const L& l) const { return a.contiguous(l); }
+        FabPtr<const Real> a;
+    };
+
+    struct TwoFab
+    {
+        TwoFab (Real* dp, const Box& dfbx, const Box& dbx, int dcomp,
+                const Real* sp, const Box& sfbx, const Box& sbx, int scomp)
+            : d(dp,dfbx,dbx,dcomp), s(sp,sfbx,sbx,scomp) {}
+        template <class L> bool contiguous (const L& l) const { return d.contiguous(l) && s.contiguous(l); }
+        FabPtr<Real>       d;
+        FabPtr<const Real> s;
+    };
+
+    struct SetValRow
+    {
+        SetValRow (Real v, Real* p, const Box& fbx, const Box& bx, int comp)
+            : val(v), d(p,fbx,bx,comp) {}
+        template <class L> bool contiguous (const L& l) const { return d.contiguous(l); }
+        void operator() (int j, int k, int n, long len)
+        {
+            Real* BL_FAB_RESTRICT dp = d.row(j,k,n);
+            const Real v = val;
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] = v;
+        }
+        Real         val;
+        FabPtr<Real> d;
+    };
+
+    struct CopyRow : TwoFab
+    {
+        CopyRow (Real* dp, const Box& dfbx, const Box& dbx, int dcomp,
+                 const Real* sp, const Box& sfbx, const Box& sbx, int scomp)
+            : TwoFab(dp,dfbx,dbx,dcomp,sp,sfbx,sbx,scomp) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            Real*       BL_FAB_RESTRICT dp = d.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp = s.row(j,k,n);
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] = sp[i];
+        }
+    };
+
+    struct PlusRow : TwoFab
+    {
+        PlusRow (Real* dp, const Box& dfbx, const Box& dbx, int dcomp,
+                 const Real* sp, const Box& sfbx, const Box& sbx, int scomp)
+            : TwoFab(dp,dfbx,dbx,dcomp,sp,sfbx,sbx,scomp) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            Real*       BL_FAB_RESTRICT dp = d.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp = s.row(j,k,n);
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] += sp[i];
+        }
+    };
+
+    struct MinusRow : TwoFab
+    {
+        MinusRow (Real* dp, const Box& dfbx, const Box& dbx, int dcomp,
+                  const Real* sp, const Box& sfbx, const Box& sbx, int scomp)
+            : TwoFab(dp,dfbx,dbx,dcomp,sp,sfbx,sbx,scomp) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            Real*       BL_FAB_RESTRICT dp = d.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp = s.row(j,k,n);
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] -= sp[i];
+        }
+    };
+
+    struct MultRow : TwoFab
+    {
+        MultRow (Real* dp, const Box& dfbx, const Box& dbx, int dcomp,
+                 const Real* sp, const Box& sfbx, const Box& sbx, int scomp)
+            : TwoFab(dp,dfbx,dbx,dcomp,sp,sfbx,sbx,scomp) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            Real*       BL_FAB_RESTRICT dp = d.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp = s.row(j,k,n);
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] *= sp[i];
+        }
+    };
+
+    struct SaxpyRow : TwoFab
+    {
+        SaxpyRow (Real sa, Real* dp, const Box& dfbx, const Box& dbx, int dcomp,
+                  const Real* sp, const Box& sfbx, const Box& sbx, int scomp)
+            : TwoFab(dp,dfbx,dbx,dcomp,sp,sfbx,sbx,scomp), a(sa) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            Real*       BL_FAB_RESTRICT dp = d.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp = s.row(j,k,n);
+            const Real sa = a;
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] += sa*sp[i];
+        }
+        Real a;
+    };
+
+    struct XpayRow : TwoFab
+    {
+        XpayRow (Real sa, Real* dp, const Box& dfbx, const Box& dbx, int dcomp,
+                 const Real* sp, const Box& sfbx, const Box& sbx, int scomp)
+            : TwoFab(dp,dfbx,dbx,dcomp,sp,sfbx,sbx,scomp), a(sa) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            Real*       BL_FAB_RESTRICT dp = d.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp = s.row(j,k,n);
+            const Real sa = a;
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] = sp[i] + sa*dp[i];
+        }
+        Real a;
+    };
+
+    struct AddProductRow
+    {
+        AddProductRow (Real* dp, const Box& dfbx, const Box& bx, int dcomp,
+                       const Real* p1, const Box& fbx1, int comp1,
+                       const Real* p2, const Box& fbx2, int comp2)
+            : d(dp,dfbx,bx,dcomp), s1(p1,fbx1,bx,comp1), s2(p2,fbx2,bx,comp2) {}
+        template <class L> bool contiguous (const L& l) const
+        {
+            return d.contiguous(l) && s1.contiguous(l) && s2.contiguous(l);
+        }
+        void operator() (int j, int k, int n, long len)
+        {
+            Real*       BL_FAB_RESTRICT dp  = d.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp1 = s1.row(j,k,n);
+            const Real* BL_FAB_RESTRICT sp2 = s2.row(j,k,n);
+            BL_FAB_SIMD
+            for (long i = 0; i < len; ++i)
+                dp[i] += sp1[i]*sp2[i];
+        }
+        FabPtr<Real>       d;
+        FabPtr<const Real> s1, s2;
+    };
+
+    struct SumRow : OneFab
+    {
+        SumRow (const Real* p, const Box& fbx, const Box& bx, int comp)
+            : OneFab(p,fbx,bx,comp), r(0) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            const Real* BL_FAB_RESTRICT ap = a.row(j,k,n);
+            Real t = r;
+            BL_FAB_SIMD_REDUCTION(+:t)
+            for (long i = 0; i < len; ++i)
+                t += ap[i];
+            r = t;
+        }
+        Real r;
+    };
+
+    struct Norm1Row : OneFab
+    {
+        Norm1Row (const Real* p, const Box& fbx, const Box& bx, int comp)
+            : OneFab(p,fbx,bx,comp), r(0) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            const Real* BL_FAB_RESTRICT ap = a.row(j,k,n);
+            Real t = r;
+            BL_FAB_SIMD_REDUCTION(+:t)
+            for (long i = 0; i < len; ++i)
+                t += std::abs(ap[i]);
+            r = t;
+        }
+        Real r;
+    };
+
+    struct NormInfRow : OneFab
+    {
+        NormInfRow (const Real* p, const Box& fbx, const Box& bx, int comp)
+            : OneFab(p,fbx,bx,comp), r(0) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            const Real* BL_FAB_RESTRICT ap = a.row(j,k,n);
+            Real t = r;
+            BL_FAB_SIMD_REDUCTION(max:t)
+            for (long i = 0; i < len; ++i)
+                t = std::max(t, std::abs(ap[i]));
+            r = t;
+        }
+        Real r;
+    };
+
+    struct MinRow : OneFab
+    {
+        MinRow (const Real* p, const Box& fbx, const Box& bx, int comp)
+            : OneFab(p,fbx,bx,comp), r(std::numeric_limits<Real>::max()) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            const Real* BL_FAB_RESTRICT ap = a.row(j,k,n);
+            Real t = r;
+            BL_FAB_SIMD_REDUCTION(min:t)
+            for (long i = 0; i < len; ++i)
+                t = std::min(t, ap[i]);
+            r = t;
+        }
+        Real r;
+    };
+
+    struct MaxRow : OneFab
+    {
+        MaxRow (const Real* p, const Box& fbx, const Box& bx, int comp)
+            : OneFab(p,fbx,bx,comp), r(-std::numeric_limits<Real>::max()) {}
+        void operator() (int j, int k, int n, long len)
+        {
+            const Real* BL_FAB_RESTRICT ap = a.row(j,k,n);
+            Real t = r;
+            BL_FAB_SIMD_REDUCTION(max:t)
+            for (long i = 0; i < len; ++i)
+                t = std::max(t, ap[i]);
+            r = t;
+        }
+        Real r;
+    };
+
+    struct DotRow
+    {
+        DotRow (const Real* xp, const Box& xfbx, const Box& xbx, int xcomp,
+                const Real* yp, const Box& yfbx, const Box& ybx, int ycomp)
+            : x(xp,xfbx,xbx,xcomp), y(yp,yfbx,ybx,ycomp), r(0) {}
+        template <class L> bool contiguous (const L& l) const { return x.contiguous(l) && y.contiguous(l); }
+        void operator() (int j, int k, int n, long len)
+        {
+            const Real* BL_FAB_RESTRICT xr = x.row(j,k,n);
+            const Real* BL_FAB_RESTRICT yr = y.row(j,k,n);
+            Real t = r;
+            BL_FAB_SIMD_REDUCTION(+:t)
+            for (long i = 0; i < len; ++i)
+                t += xr[i]*yr[i];
+            r = t;
+        }
+        FabPtr<const Real> x, y;
+        Real               r;
+    };
+    //
+    // Calls f(j,k,n,len) once per row of bx.  NC > 0 fixes the number of
+    // components at compile time.
+    //
+    template <int NC, class F>
+    void
+    fab_loop_nc (const Box& bx, int ncomp, F& f)
+    {
+        const int     nc  = (NC > 0) ? NC : ncomp;
+        const IntVect len = bx.size();
+
+        if (f.contiguous(len))
+        {
+            const long npts = D_TERM(long(len[0]), *len[1], *len[2]);
+
+            if (nc == 1 || f.contiguous(npts))
+            {
+                f(0, 0, 0, npts*nc);
+            }
+            else
+            {
+                for (int n = 0; n < nc; ++n)
+                    f(0, 0, n, npts);
+            }
+            return;
+        }
+
+        for (int n = 0; n < nc; ++n)
+        {
+#if (BL_SPACEDIM == 3)
+            for (int k = 0; k < len[2]; ++k)
+#else
+            const int k = 0;
+#endif
+            {
+#if (BL_SPACEDIM >= 2)
+                for (int j = 0; j < len[1]; ++j)
+#else
+                const int j = 0;
+#endif
+                {
+                    f(j, k, n, len[0]);
+                }
+            }
+        }
+    }
+
+    template <class F>
+    void
+    fab_loop (const Box& bx, int ncomp, F& f)
+    {
+        if (ncomp == 1)
+            fab_loop_nc<1>(bx, 1, f);
+        else
+            fab_loop_nc<0>(bx, ncomp, f);
+    }
+}
+
+bool
+BoxLib::SetFabCxxKernels (bool tf)
+{
+    bool r = cxx_kernels;
+#ifdef BL_FORT_FAB_KERNELS
+    cxx_kernels = tf;
+#endif
+    return r;
+}
+
+bool
+BoxLib::FabCxxKernels ()
+{
+    return cxx_kernels;
+}
+
 template<>
 void
 BaseFab<Real>::performCopy (const BaseFab<Real>& src,
@@ -179,10 +637,20 @@ BaseFab<Real>::performCopy (const BaseFab<Real>& src,
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= src.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= nComp());
 
-    fort_fab_copy(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
-		  BL_TO_FORTRAN_N_3D(*this,destcomp),
-		  BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
-		  &numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_copy(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
+                      BL_TO_FORTRAN_N_3D(*this,destcomp),
+                      BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
+                      &numcomp);
+        return;
+    }
+#endif
+
+    CopyRow f(dataPtr(), domain, destbox, destcomp,
+              src.dataPtr(), src.box(), srcbox, srccomp);
+    fab_loop(destbox, numcomp, f);
 }
 
 template <>
@@ -197,10 +665,19 @@ BaseFab<Real>::copyToMem (const Box& srcbox,
 
     if (srcbox.ok())
     {
-	fort_fab_copytomem(ARLIM_3D(srcbox.loVect()), ARLIM_3D(srcbox.hiVect()),
-			   dst,
-			   BL_TO_FORTRAN_N_3D(*this,srccomp),
-			   &numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+        if (!cxx_kernels)
+        {
+            fort_fab_copytomem(ARLIM_3D(srcbox.loVect()), ARLIM_3D(srcbox.hiVect()),
+                               dst,
+                               BL_TO_FORTRAN_N_3D(*this,srccomp),
+                               &numcomp);
+            return;
+        }
+#endif
+        CopyRow f(dst, srcbox, srcbox, 0,
+                  dataPtr(), domain, srcbox, srccomp);
+        fab_loop(srcbox, numcomp, f);
     }
 }
 
@@ -214,11 +691,20 @@ BaseFab<Real>::copyFromMem (const Box&  dstbox,
     BL_ASSERT(box().contains(dstbox));
     BL_ASSERT(dstcomp >= 0 && dstcomp+numcomp <= nComp());
 
-    if (dstbox.ok()) 
+    if (dstbox.ok())
     {
-	fort_fab_copyfrommem(ARLIM_3D(dstbox.loVect()), ARLIM_3D(dstbox.hiVect()),
-			     BL_TO_FORTRAN_N_3D(*this,dstcomp), &numcomp,
-			     src);
+#ifdef BL_FORT_FAB_KERNELS
+        if (!cxx_kernels)
+        {
+            fort_fab_copyfrommem(ARLIM_3D(dstbox.loVect()), ARLIM_3D(dstbox.hiVect()),
+                                 BL_TO_FORTRAN_N_3D(*this,dstcomp), &numcomp,
+                                 src);
+            return;
+        }
+#endif
+        CopyRow f(dataPtr(), domain, dstbox, dstcomp,
+                  src, dstbox, dstbox, 0);
+        fab_loop(dstbox, numcomp, f);
     }
 }
 
@@ -232,25 +718,18 @@ BaseFab<Real>::performSetVal (Real       val,
     BL_ASSERT(domain.contains(bx));
     BL_ASSERT(comp >= 0 && comp + ncomp <= nvar);
 
-    fort_fab_setval(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
-		    BL_TO_FORTRAN_N_3D(*this,comp), &ncomp,
-		    &val);
-}
-
-template<>
-BaseFab<Real>&
-BaseFab<Real>::invert (Real       val,
-                       const Box& bx,
-                       int        comp,
-                       int        ncomp)
-{
-    BL_ASSERT(domain.contains(bx));
-    BL_ASSERT(comp >= 0 && comp + ncomp <= nvar);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_setval(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                        BL_TO_FORTRAN_N_3D(*this,comp), &ncomp,
+                        &val);
+        return;
+    }
+#endif
 
-    fort_fab_invert(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
-		    BL_TO_FORTRAN_N_3D(*this,comp), &ncomp,
-		    &val);
-    return *this;
+    SetValRow f(val, dataPtr(), domain, bx, comp);
+    fab_loop(bx, ncomp, f);
 }
 
 template<>
@@ -263,13 +742,30 @@ BaseFab<Real>::norm (const Box& bx,
     BL_ASSERT(domain.contains(bx));
     BL_ASSERT(comp >= 0 && comp + ncomp <= nvar);
 
-    Real nrm;
+    Real nrm = 0;
 
     if (p == 0 || p == 1)
     {
-	nrm = fort_fab_norm(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
-			    BL_TO_FORTRAN_N_3D(*this,comp), &ncomp,
-			    &p);
+#ifdef BL_FORT_FAB_KERNELS
+        if (!cxx_kernels)
+        {
+            return fort_fab_norm(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                                 BL_TO_FORTRAN_N_3D(*this,comp), &ncomp,
+                                 &p);
+        }
+#endif
+        if (p == 0)
+        {
+            NormInfRow f(dataPtr(), domain, bx, comp);
+            fab_loop(bx, ncomp, f);
+            nrm = f.r;
+        }
+        else
+        {
+            Norm1Row f(dataPtr(), domain, bx, comp);
+            fab_loop(bx, ncomp, f);
+            nrm = f.r;
+        }
     }
     else
     {
@@ -288,8 +784,43 @@ BaseFab<Real>::sum (const Box& bx,
     BL_ASSERT(domain.contains(bx));
     BL_ASSERT(comp >= 0 && comp + ncomp <= nvar);
 
-    return fort_fab_sum(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
-			BL_TO_FORTRAN_N_3D(*this,comp), &ncomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        return fort_fab_sum(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+                            BL_TO_FORTRAN_N_3D(*this,comp), &ncomp);
+    }
+#endif
+
+    SumRow f(dataPtr(), domain, bx, comp);
+    fab_loop(bx, ncomp, f);
+    return f.r;
+}
+
+template<>
+Real
+BaseFab<Real>::min (const Box& subbox,
+                    int        comp) const
+{
+    BL_ASSERT(domain.contains(subbox));
+    BL_ASSERT(comp >= 0 && comp < nvar);
+
+    MinRow f(dataPtr(), domain, subbox, comp);
+    fab_loop(subbox, 1, f);
+    return f.r;
+}
+
+template<>
+Real
+BaseFab<Real>::max (const Box& subbox,
+                    int        comp) const
+{
+    BL_ASSERT(domain.contains(subbox));
+    BL_ASSERT(comp >= 0 && comp < nvar);
+
+    MaxRow f(dataPtr(), domain, subbox, comp);
+    fab_loop(subbox, 1, f);
+    return f.r;
 }
 
 template<>
@@ -308,11 +839,20 @@ BaseFab<Real>::plus (const BaseFab<Real>& src,
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= src.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= nComp());
 
-    fort_fab_plus(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
-		  BL_TO_FORTRAN_N_3D(*this,destcomp),
-		  BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
-		  &numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_plus(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
+                      BL_TO_FORTRAN_N_3D(*this,destcomp),
+                      BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
+                      &numcomp);
+        return *this;
+    }
+#endif
 
+    PlusRow f(dataPtr(), domain, destbox, destcomp,
+              src.dataPtr(), src.box(), srcbox, srccomp);
+    fab_loop(destbox, numcomp, f);
     return *this;
 }
 
@@ -332,10 +872,20 @@ BaseFab<Real>::mult (const BaseFab<Real>& src,
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= src.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= nComp());
 
-    fort_fab_mult(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
-		  BL_TO_FORTRAN_N_3D(*this,destcomp),
-		  BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
-		  &numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_mult(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
+                      BL_TO_FORTRAN_N_3D(*this,destcomp),
+                      BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
+                      &numcomp);
+        return *this;
+    }
+#endif
+
+    MultRow f(dataPtr(), domain, destbox, destcomp,
+              src.dataPtr(), src.box(), srcbox, srccomp);
+    fab_loop(destbox, numcomp, f);
     return *this;
 }
 
@@ -356,11 +906,21 @@ BaseFab<Real>::saxpy (Real a, const BaseFab<Real>& src,
     BL_ASSERT( srccomp >= 0 &&  srccomp+numcomp <= src.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <=     nComp());
 
-    fort_fab_saxpy(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
-		   BL_TO_FORTRAN_N_3D(*this,destcomp),
-		   &a,
-		   BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
-		   &numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_saxpy(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
+                       BL_TO_FORTRAN_N_3D(*this,destcomp),
+                       &a,
+                       BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
+                       &numcomp);
+        return *this;
+    }
+#endif
+
+    SaxpyRow f(a, dataPtr(), domain, destbox, destcomp,
+               src.dataPtr(), src.box(), srcbox, srccomp);
+    fab_loop(destbox, numcomp, f);
     return *this;
 }
 
@@ -381,11 +941,21 @@ BaseFab<Real>::xpay (Real a, const BaseFab<Real>& src,
     BL_ASSERT( srccomp >= 0 &&  srccomp+numcomp <= src.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <=     nComp());
 
-    fort_fab_xpay(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
-		  BL_TO_FORTRAN_N_3D(*this,destcomp),
-		  &a,
-		  BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
-		  &numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_xpay(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
+                      BL_TO_FORTRAN_N_3D(*this,destcomp),
+                      &a,
+                      BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
+                      &numcomp);
+        return *this;
+    }
+#endif
+
+    XpayRow f(a, dataPtr(), domain, destbox, destcomp,
+              src.dataPtr(), src.box(), srcbox, srccomp);
+    fab_loop(destbox, numcomp, f);
     return *this;
 }
 
@@ -405,11 +975,22 @@ BaseFab<Real>::addproduct (const Box&           destbox,
     BL_ASSERT(   comp2 >= 0 &&    comp2+numcomp <= src2.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <=      nComp());
 
-    fort_fab_addproduct(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
-			BL_TO_FORTRAN_N_3D(*this,destcomp),
-			BL_TO_FORTRAN_N_3D(src1,comp1),
-			BL_TO_FORTRAN_N_3D(src2,comp2),
-			&numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_addproduct(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
+                            BL_TO_FORTRAN_N_3D(*this,destcomp),
+                            BL_TO_FORTRAN_N_3D(src1,comp1),
+                            BL_TO_FORTRAN_N_3D(src2,comp2),
+                            &numcomp);
+        return *this;
+    }
+#endif
+
+    AddProductRow f(dataPtr(), domain, destbox, destcomp,
+                    src1.dataPtr(), src1.box(), comp1,
+                    src2.dataPtr(), src2.box(), comp2);
+    fab_loop(destbox, numcomp, f);
     return *this;
 }
 
@@ -429,10 +1010,69 @@ BaseFab<Real>::minus (const BaseFab<Real>& src,
     BL_ASSERT(srccomp >= 0 && srccomp+numcomp <= src.nComp());
     BL_ASSERT(destcomp >= 0 && destcomp+numcomp <= nComp());
 
-    fort_fab_minus(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
-		   BL_TO_FORTRAN_N_3D(*this,destcomp),
-		   BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
-		   &numcomp);
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        fort_fab_minus(ARLIM_3D(destbox.loVect()), ARLIM_3D(destbox.hiVect()),
+                       BL_TO_FORTRAN_N_3D(*this,destcomp),
+                       BL_TO_FORTRAN_N_3D(src,srccomp), ARLIM_3D(srcbox.loVect()),
+                       &numcomp);
+        return *this;
+    }
+#endif
+
+    MinusRow f(dataPtr(), domain, destbox, destcomp,
+               src.dataPtr(), src.box(), srcbox, srccomp);
+    fab_loop(destbox, numcomp, f);
+    return *this;
+}
+
+template <>
+Real
+BaseFab<Real>::dot (const Box& xbx, int xcomp,
+		    const BaseFab<Real>& y, const Box& ybx, int ycomp,
+		    int numcomp) const
+{
+    BL_ASSERT(xbx.ok());
+    BL_ASSERT(box().contains(xbx));
+    BL_ASSERT(y.box().contains(ybx));
+    BL_ASSERT(xbx.sameSize(ybx));
+    BL_ASSERT(xcomp >= 0 && xcomp+numcomp <=   nComp());
+    BL_ASSERT(ycomp >= 0 && ycomp+numcomp <= y.nComp());
+
+#ifdef BL_FORT_FAB_KERNELS
+    if (!cxx_kernels)
+    {
+        return fort_fab_dot(ARLIM_3D(xbx.loVect()), ARLIM_3D(xbx.hiVect()),
+                            BL_TO_FORTRAN_N_3D(*this,xcomp),
+                            BL_TO_FORTRAN_N_3D(y,ycomp), ARLIM_3D(ybx.loVect()),
+                            &numcomp);
+    }
+#endif
+
+    DotRow f(dataPtr(), domain, xbx, xcomp,
+             y.dataPtr(), y.box(), ybx, ycomp);
+    fab_loop(xbx, numcomp, f);
+    return f.r;
+}
+
+#ifdef BL_FORT_FAB_KERNELS
+//
+// These are only available in Fortran.
+//
+template<>
+BaseFab<Real>&
+BaseFab<Real>::invert (Real       val,
+                       const Box& bx,
+                       int        comp,
+                       int        ncomp)
+{
+    BL_ASSERT(domain.contains(bx));
+    BL_ASSERT(comp >= 0 && comp + ncomp <= nvar);
+
+    fort_fab_invert(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
+		    BL_TO_FORTRAN_N_3D(*this,comp), &ncomp,
+		    &val);
     return *this;
 }
 
@@ -516,23 +1156,4 @@ BaseFab<Real>::linComb (const BaseFab<Real>& f1,
     return *this;
 }
 
-template <>
-Real
-BaseFab<Real>::dot (const Box& xbx, int xcomp, 
-		    const BaseFab<Real>& y, const Box& ybx, int ycomp,
-		    int numcomp) const
-{
-    BL_ASSERT(xbx.ok());
-    BL_ASSERT(box().contains(xbx));
-    BL_ASSERT(y.box().contains(ybx));
-    BL_ASSERT(xbx.sameSize(ybx));
-    BL_ASSERT(xcomp >= 0 && xcomp+numcomp <=   nComp());
-    BL_ASSERT(ycomp >= 0 && ycomp+numcomp <= y.nComp());
-
-    return fort_fab_dot(ARLIM_3D(xbx.loVect()), ARLIM_3D(xbx.hiVect()),
-			BL_TO_FORTRAN_N_3D(*this,xcomp),
-			BL_TO_FORTRAN_N_3D(y,ycomp), ARLIM_3D(ybx.loVect()),
-			&numcomp);
-}
-
 #endif
@@ -1,7 +1,10 @@
 
+#include <algorithm>
+
 #include <BLassert.H>
 #include <BoxArray.H>
 #include <ParallelDescriptor.H>
+#include <ParmParse.H>
 #include <Utility.H>
 
 #ifdef BL_MEM_PROFILING
@@ -17,10 +20,37 @@ long BARef::total_hash_bytes_hwm = 0L;
 bool    BARef::initialized = false;
 bool BoxArray::initialized = false;
 
+int BARef::index_type = BARef::BVH;
+
 BoxArray::CBACache BoxArray::m_CoarseBoxArrayCache;
 
 namespace {
     const int bl_ignore_max = 100000;
+    //
+    // Orders box indices by the centers of the boxes in direction dir.
+    //
+    struct BoxCenterLess
+    {
+	BoxCenterLess (const Array<Box>& boxes, int dir) : m_boxes(boxes), m_dir(dir) {}
+	bool operator() (int i, int j) const {
+	    const int ci = m_boxes[i].smallEnd(m_dir) + m_boxes[i].bigEnd(m_dir);
+	    const int cj = m_boxes[j].smallEnd(m_dir) + m_boxes[j].bigEnd(m_dir);
+	    return (ci < cj) || (ci == cj && i < j);
+	}
+	const Array<Box>& m_boxes;
+	int m_dir;
+    };
+
+    struct IsectIndexLess
+    {
+	bool operator() (const std::pair<int,Box>& a, const std::pair<int,Box>& b) const {
+	    return a.first < b.first;
+	}
+    };
+    //
+    // Number of boxes in a leaf of the BVH.
+    //
+    const int bvh_leaf_size = 4;
 }
 
 BARef::BARef () 
@@ -123,6 +153,8 @@ BARef::resize (long n) {
 #endif
     m_abox.resize(n);
     hash.clear();
+    bvh.clear();
+    bvh_index.clear();
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(1);
 #endif
@@ -149,12 +181,13 @@ BARef::updateMemoryUsage_box (int s)
 void
 BARef::updateMemoryUsage_hash (int s)
 {
-    if (hash.size() > 0) {
+    if (hash.size() > 0 || bvh.size() > 0) {
 	long b = sizeof(hash);
 	for (const auto& x: hash) {
 	    b += BoxLib::gcc_map_node_extra_bytes
 		+ sizeof(IntVect) + BoxLib::bytesOf(x.second);
 	}
+	b += BoxLib::bytesOf(bvh) + BoxLib::bytesOf(bvh_index);
 	if (s > 0) {
 	    total_hash_bytes += b;
 	    total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
@@ -193,6 +226,18 @@ BoxArray::Initialize ()
     if (!initialized) {
 	initialized = true;
 	BARef::Initialize();
+
+	ParmParse pp("boxarray");
+	std::string index;
+	if (pp.query("index", index)) {
+	    if (index == "hash") {
+		BARef::index_type = BARef::Hash;
+	    } else if (index == "bvh") {
+		BARef::index_type = BARef::BVH;
+	    } else {
+		BoxLib::Abort("BoxArray::Initialize: boxarray.index must be hash or bvh");
+	    }
+	}
     }
 }
 
@@ -863,7 +908,116 @@ BoxArray::intersections (const Box&                         bx,
 {
     // called too many times  BL_PROFILE("BoxArray::intersections()");
 
-    BARef::HashType& BoxHashMap = getHashMap();
+    if (BARef::index_type == BARef::Hash) {
+	intersections_hash(bx, isects, first_only, ng);
+    } else {
+	intersections_bvh(bx, isects, first_only, ng);
+    }
+}
+
+void
+BoxArray::intersections (const Array<Box>&                           bxs,
+			 Array< std::vector< std::pair<int,Box> > >& isects,
+			 int                                         ng) const
+{
+    BL_PROFILE("BoxArray::intersections(batch)");
+
+    const int N = bxs.size();
+
+    isects.resize(N);
+
+    if (N == 0) return;
+    //
+    // Build the index up front so the queries need no lock.
+    //
+    const bool use_hash = BARef::index_type == BARef::Hash;
+    if (use_hash) {
+	getHashMap();
+    } else {
+	getBVH();
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,16)
+#endif
+    for (int i = 0; i < N; ++i)
+    {
+	if (use_hash) {
+	    intersections_hash(bxs[i], isects[i], false, ng, false);
+	} else {
+	    intersections_bvh(bxs[i], isects[i], false, ng, false);
+	}
+    }
+}
+
+void
+BoxArray::intersections_bvh (const Box&                         bx,
+			     std::vector< std::pair<int,Box> >& isects,
+			     bool                               first_only,
+			     int                                ng,
+			     bool                               build_index) const
+{
+    const std::vector<BARef::BVHNode>& bvh = build_index ? getBVH() : m_ref->bvh;
+
+    isects.resize(0);
+
+    if (bvh.empty()) return;
+
+    BL_ASSERT(bx.ixType() == ixType());
+    //
+    // The cell-centered boxes that can intersect bx.
+    //
+    const Box& gbx = BoxLib::grow(bx,ng);
+    const Box qbx(gbx.smallEnd() - m_transformer->doiHi(),
+		  gbx.bigEnd()   + m_transformer->doiLo());
+
+    const std::vector<int>& bvh_index = m_ref->bvh_index;
+
+    int stack[128];
+    int nstack = 0;
+    stack[nstack++] = 0;
+
+    while (nstack > 0)
+    {
+	const BARef::BVHNode& node = bvh[stack[--nstack]];
+
+	if (!node.bbox.intersects(qbx)) continue;
+
+	if (node.child < 0)
+	{
+	    for (int k = node.lo; k < node.hi; ++k)
+	    {
+		const int  index = bvh_index[k];
+		const Box& isect = bx & BoxLib::grow(get(index),ng);
+
+		if (isect.ok())
+		{
+		    isects.push_back(std::pair<int,Box>(index,isect));
+		    if (first_only) return;
+		}
+	    }
+	}
+	else
+	{
+	    BL_ASSERT(nstack+2 <= 128);
+	    stack[nstack++] = node.child+1;
+	    stack[nstack++] = node.child;
+	}
+    }
+    //
+    // Report them in the order of the boxes in the BoxArray.
+    //
+    std::sort(isects.begin(), isects.end(), IsectIndexLess());
+}
+
+void
+BoxArray::intersections_hash (const Box&                         bx,
+			      std::vector< std::pair<int,Box> >& isects,
+			      bool                               first_only,
+			      int                                ng,
+			      bool                               build_index) const
+{
+    BARef::HashType& BoxHashMap = build_index ? getHashMap() : m_ref->hash;
 
     isects.resize(0);
 
@@ -921,54 +1075,23 @@ BoxArray::complement (const Box& bx) const
 
     if (!empty()) 
     {
-	BARef::HashType& BoxHashMap = getHashMap();
-
 	BL_ASSERT(bx.ixType() == ixType());
 
-	Box gbx = bx;
-
-	IntVect glo = gbx.smallEnd();
-	IntVect ghi = gbx.bigEnd();
-	const IntVect& doilo = m_transformer->doiLo();
-	const IntVect& doihi = m_transformer->doiHi();
-
-	gbx.setSmall(glo - doihi).setBig(ghi + doilo);
-        gbx.coarsen(m_ref->crsn);
-	
-        const IntVect& sm = BoxLib::max(gbx.smallEnd()-1, m_ref->bbox.smallEnd());
-        const IntVect& bg = BoxLib::min(gbx.bigEnd(),     m_ref->bbox.bigEnd());
-
-        Box cbx(sm,bg);
-
-	BARef::HashType::const_iterator TheEnd = BoxHashMap.end();
+	std::vector< std::pair<int,Box> > isects;
 
-	for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); 
-	     iv <= End && bl.isNotEmpty(); 
-	     cbx.next(iv))
-        {
-            BARef::HashType::const_iterator it = BoxHashMap.find(iv);
+	intersections(bx,isects);
 
-            if (it != TheEnd)
-            {
-                for (std::vector<int>::const_iterator v_it = it->second.begin(), v_end = it->second.end(); 
-		     v_it != v_end && bl.isNotEmpty(); 
-		     ++v_it)
-                {
-                    const int  index = *v_it;
-                    const Box& isect = bx & get(index);
+	for (int i = 0, N = isects.size(); i < N && bl.isNotEmpty(); ++i)
+	{
+	    const Box& isect = isects[i].second;
 
-                    if (isect.ok())
-                    {
-			for (BoxList::iterator bli = bl.begin(); bli != bl.end(); )
-			{
-			    BoxList diff = BoxLib::boxDiff(*bli, isect);
-			    bl.splice_front(diff);
-			    bl.remove(bli++);
-			}
-                    }
-                }
-            }
-        }
+	    for (BoxList::iterator bli = bl.begin(); bli != bl.end(); )
+	    {
+		BoxList diff = BoxLib::boxDiff(*bli, isect);
+		bl.splice_front(diff);
+		bl.remove(bli++);
+	    }
+	}
     }
 
     return bl;
@@ -977,12 +1100,14 @@ BoxArray::complement (const Box& bx) const
 void
 BoxArray::clear_hash_bin () const
 {
-    if (!m_ref->hash.empty())
+    if (!m_ref->hash.empty() || !m_ref->bvh.empty())
     {
 #ifdef BL_MEM_PROFILING
 	m_ref->updateMemoryUsage_hash(-1);
 #endif
         m_ref->hash.clear();
+        m_ref->bvh.clear();
+        m_ref->bvh_index.clear();
     }
 }
 
@@ -1017,7 +1142,10 @@ BoxArray::removeOverlap ()
     {
         if (m_ref->m_abox[i].ok())
         {
-            intersections(m_ref->m_abox[i],isects);
+            //
+            // The hash is updated below as boxes are added, the BVH is not.
+            //
+            intersections_hash(m_ref->m_abox[i],isects,false,0);
 
             for (int j = 0, N = isects.size(); j < N; j++)
             {
@@ -1175,6 +1303,91 @@ BoxArray::getHashMap () const
     return BoxHashMap;
 }
 
+const std::vector<BARef::BVHNode>&
+BoxArray::getBVH () const
+{
+    std::vector<BARef::BVHNode>& bvh = m_ref->bvh;
+
+#ifdef _OPENMP
+    #pragma omp critical(intersections_lock)
+#endif
+    {
+        if (bvh.empty() && size() > 0)
+        {
+	    const Array<Box>& abox = m_ref->m_abox;
+	    std::vector<int>& bvh_index = m_ref->bvh_index;
+
+	    const int N = size();
+
+	    bvh_index.reserve(N);
+	    for (int i = 0; i < N; ++i) {
+		if (abox[i].ok()) bvh_index.push_back(i);
+	    }
+	    //
+	    // Top-down construction: split the boxes of a node in half at the
+	    // median of their centers along the longest side of the node.
+	    //
+	    BARef::BVHNode root;
+	    root.lo    = 0;
+	    root.hi    = bvh_index.size();
+	    root.child = -1;
+	    bvh.push_back(root);
+
+	    std::vector<int> todo(1,0);
+
+	    while (!todo.empty())
+	    {
+		const int k = todo.back();
+		todo.pop_back();
+
+		const int lo = bvh[k].lo;
+		const int hi = bvh[k].hi;
+
+		Box bbox;
+		if (hi > lo) {
+		    bbox = abox[bvh_index[lo]];
+		    for (int i = lo+1; i < hi; ++i)
+			bbox.minBox(abox[bvh_index[i]]);
+		}
+		bvh[k].bbox = bbox;
+
+		if (hi - lo > bvh_leaf_size)
+		{
+		    int dir = 0;
+		    for (int d = 1; d < BL_SPACEDIM; ++d) {
+			if (bbox.length(d) > bbox.length(dir)) dir = d;
+		    }
+
+		    const int mid = (lo + hi) / 2;
+		    std::nth_element(bvh_index.begin()+lo, bvh_index.begin()+mid,
+				     bvh_index.begin()+hi, BoxCenterLess(abox,dir));
+
+		    const int child = bvh.size();
+		    bvh[k].child = child;
+
+		    BARef::BVHNode node;
+		    node.child = -1;
+		    node.lo = lo;
+		    node.hi = mid;
+		    bvh.push_back(node);
+		    node.lo = mid;
+		    node.hi = hi;
+		    bvh.push_back(node);
+
+		    todo.push_back(child);
+		    todo.push_back(child+1);
+		}
+	    }
+
+#ifdef BL_MEM_PROFILING
+	    m_ref->updateMemoryUsage_hash(1);
+#endif
+        }
+    }
+
+    return bvh;
+}
+
 void
 BoxArray::uniqify ()
 {
@@ -372,6 +372,8 @@ BoxLib::Initialize (int& argc, char**& argv, bool build_parm_parse, MPI_Comm mpi
 
     mempool_init();
 
+    BoxLib::InitializeArena();
+
     // For thread safety, we should do these initializations here.
     BoxArray::Initialize();
     DistributionMapping::Initialize();
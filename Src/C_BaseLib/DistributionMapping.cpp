@@ -47,6 +47,11 @@ namespace
     int    sfc_threshold;
     Real   max_efficiency;
     int    node_size;
+    int    cost_window;
+    Real   lb_bandwidth;
+    int    parallel_map_threshold;
+    int    graph_ngrow;
+    Real   graph_imbalance;
 }
 
 // We default to SFC.
@@ -103,6 +108,9 @@ DistributionMapping::strategy (DistributionMapping::Strategy how)
     case RRSFC:
         m_BuildMap = &DistributionMapping::RRSFCProcessorMap;
         break;
+    case GRAPH:
+        m_BuildMap = &DistributionMapping::GraphProcessorMap;
+        break;
     default:
         BoxLib::Error("Bad DistributionMapping::Strategy");
     }
@@ -143,6 +151,11 @@ DistributionMapping::Initialize ()
     sfc_threshold    = 0;
     max_efficiency   = 0.9;
     node_size        = 0;
+    cost_window      = 5;
+    lb_bandwidth     = 1.e9;
+    parallel_map_threshold = 20000;
+    graph_ngrow      = 1;
+    graph_imbalance  = 0.02;
 
     ParmParse pp("DistributionMapping");
 
@@ -151,6 +164,14 @@ DistributionMapping::Initialize ()
     pp.query("efficiency",       max_efficiency);
     pp.query("sfc_threshold",    sfc_threshold);
     pp.query("node_size",        node_size);
+    pp.query("cost_window",      cost_window);
+    pp.query("lb_bandwidth",     lb_bandwidth);
+    pp.query("parallel_map_threshold", parallel_map_threshold);
+    pp.query("graph_ngrow",      graph_ngrow);
+    pp.query("graph_imbalance",  graph_imbalance);
+
+    if (cost_window < 1)
+        BoxLib::Abort("DistributionMapping.cost_window must be at least 1");
 
     std::string theStrategy;
 
@@ -177,6 +198,10 @@ DistributionMapping::Initialize ()
         {
             strategy(RRSFC);
         }
+        else if (theStrategy == "GRAPH")
+        {
+            strategy(GRAPH);
+        }
         else
         {
             std::string msg("Unknown strategy: ");
@@ -545,6 +570,81 @@ DistributionMapping::define (const BoxArray& boxes,
     }
 }
 
+void
+DistributionMapping::define (const BoxArray&            boxes,
+                             int                        nprocs,
+                             const BoxArray&            old_boxes,
+                             const DistributionMapping& old_map)
+{
+    BL_PROFILE("DistributionMapping::define(old)");
+
+    m_color = ParallelDescriptor::DefaultColor();
+
+    const int N = boxes.size();
+
+    Array<int>  pmap(N + 1);
+    Array<long> load(nprocs,0);
+
+    std::vector<LIpair> rest;
+
+    std::vector< std::pair<int,Box> > isects;
+
+    for (int i = 0; i < N; i++)
+    {
+        const Box& bx  = boxes[i];
+        int        who = -1;
+
+        old_boxes.intersections(bx,isects);
+
+        for (int k = 0, M = isects.size(); k < M && who < 0; k++)
+        {
+            if (old_boxes[isects[k].first] == bx)
+                who = old_map[isects[k].first];
+        }
+
+        if (who >= 0 && who < nprocs)
+        {
+            pmap[i]    = who;
+            load[who] += bx.numPts();
+        }
+        else
+        {
+            rest.push_back(LIpair(bx.numPts(),i));
+        }
+    }
+    //
+    // Largest first; ties in box order so every CPU gets the same map.
+    //
+    std::stable_sort(rest.begin(), rest.end(), LIpairGT());
+
+    for (int i = 0, M = rest.size(); i < M; i++)
+    {
+        const int who = std::min_element(load.begin(), load.end()) - load.begin();
+
+        pmap[rest[i].second] = who;
+        load[who]           += rest[i].first;
+    }
+    //
+    // Set sentinel equal to our processor number.
+    //
+    pmap[N] = ParallelDescriptor::MyProc();
+
+    define(pmap);
+}
+
+bool
+DistributionMapping::MapInCache (int                       nboxes,
+                                 ParallelDescriptor::Color color)
+{
+    return m_Cache.find(std::make_pair(nboxes+1,color.to_int())) != m_Cache.end();
+}
+
+void
+DistributionMapping::ReplaceInCache (const DistributionMapping& dm)
+{
+    m_Cache[std::make_pair(dm.m_ref->m_pmap.size(),dm.m_color.to_int())] = dm.m_ref;
+}
+
 void
 DistributionMapping::define (const Array<int>& pmap)
 {
@@ -788,6 +888,68 @@ public:
     }
 };
 
+//
+// Finds the first improving swap in the order of the serial search in
+// knapsack(), with each process scanning a slice of the lighter bins.
+// On success ia is the position of the ball in the heaviest bin and ic
+// that of the other bin in wblqg.  Collective.
+//
+static
+bool
+FindSwapParallel (std::list<WeightedBoxList>& wblqg,
+                  int&                        ia,
+                  int&                        ic)
+{
+    const int nbins  = wblqg.size();
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+    const int cbegin = 1 + (long(nbins-1)* myproc   )/nprocs;
+    const int cend   = 1 + (long(nbins-1)*(myproc+1))/nprocs;
+
+    std::list<WeightedBoxList>::iterator it_top = wblqg.begin();
+    const long w_top = (*it_top).weight();
+
+    std::list<WeightedBoxList>::iterator it_begin = it_top;
+    std::advance(it_begin, cbegin);
+
+    long found = std::numeric_limits<long>::max();
+
+    int a = 0;
+    for (std::list<WeightedBox>::iterator it_wb = (*it_top).begin();
+         it_wb != (*it_top).end() && found == std::numeric_limits<long>::max();
+         ++it_wb, ++a)
+    {
+        std::list<WeightedBoxList>::iterator it_chk = it_begin;
+        for (int c = cbegin; c < cend; ++c, ++it_chk)
+        {
+            const long w_chk = (*it_chk).weight();
+            std::list<WeightedBox>::iterator it_owb = (*it_chk).begin();
+            for ( ; it_owb != (*it_chk).end(); ++it_owb)
+            {
+                const long w_tb = w_top + (*it_owb).weight() - (*it_wb).weight();
+                const long w_ob = w_chk + (*it_wb).weight() - (*it_owb).weight();
+                if (w_tb < w_top && w_ob < w_top)
+                    break;
+            }
+            if (it_owb != (*it_chk).end())
+            {
+                found = long(a)*nbins + c;
+                break;
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceLongMin(found);
+
+    if (found == std::numeric_limits<long>::max())
+        return false;
+
+    ia = found / nbins;
+    ic = found % nbins;
+
+    return true;
+}
+
 static
 void
 knapsack (const std::vector<long>&         wgts,
@@ -795,7 +957,8 @@ knapsack (const std::vector<long>&         wgts,
           std::vector< std::vector<int> >& result,
           Real&                            efficiency,
           bool                             do_full_knapsack,
-	  int                              nmax)
+	  int                              nmax,
+          bool                             parallel = false)
 {
     //
     // Sort balls by size largest first.
@@ -868,6 +1031,47 @@ top:
 
     if (efficiency > max_efficiency || !do_full_knapsack) goto bottom;
 
+    if (parallel)
+    {
+        //
+        // Same swap as below, but the search is split across processes.
+        //
+        int ia, ic;
+        if (!FindSwapParallel(wblqg, ia, ic)) goto bottom;
+
+        std::advance(it_wb, ia);
+        std::list<WeightedBoxList>::iterator it_chk = it_top;
+        std::advance(it_chk, ic);
+
+        WeightedBoxList wbl_chk = *it_chk;
+        std::list<WeightedBox>::iterator it_owb = wbl_chk.begin();
+        for ( ; it_owb != wbl_chk.end(); ++it_owb)
+        {
+            Real w_tb = (*it_top).weight() + (*it_owb).weight() - (*it_wb).weight();
+            Real w_ob = (*it_chk).weight() + (*it_wb).weight() - (*it_owb).weight();
+            if (w_tb < (*it_top).weight() && w_ob < (*it_top).weight())
+                break;
+        }
+        BL_ASSERT(it_owb != wbl_chk.end());
+
+        WeightedBox wb = *it_wb;
+        WeightedBox owb = *it_owb;
+        wblqg.erase(it_top);
+        wblqg.erase(it_chk);
+        wbl_top.erase(it_wb);
+        wbl_chk.erase(it_owb);
+        wbl_top.push_back(owb);
+        wbl_chk.push_back(wb);
+        std::list<WeightedBoxList> tmp;
+        tmp.push_back(wbl_top);
+        tmp.push_back(wbl_chk);
+        tmp.sort();
+        wblqg.merge(tmp);
+        max_weight = (*wblqg.begin()).weight();
+        efficiency = sum_weight/(nprocs*max_weight);
+        goto top;
+    }
+
     for ( ; it_wb != wbl_top.end(); ++it_wb )
     {
         //
@@ -972,7 +1176,11 @@ DistributionMapping::KnapSackDoIt (const std::vector<long>& wgts,
 
     efficiency = 0;
 
-    knapsack(wgts,nteams,vec,efficiency,do_full_knapsack,nmax);
+    const bool parallel = wgts.size() >= parallel_map_threshold &&
+                          ParallelDescriptor::NProcs() > 1 &&
+                          ParallelDescriptor::NColors() == 1;
+
+    knapsack(wgts,nteams,vec,efficiency,do_full_knapsack,nmax,parallel);
 
     BL_ASSERT(vec.size() == nteams);
 
@@ -1148,6 +1356,22 @@ SFCToken::Compare::operator () (const SFCToken& lhs,
     return false;
 }
 
+namespace
+{
+    struct PrefixLess
+    {
+        PrefixLess (const std::vector<Real>& pre, Real vol) : m_pre(pre), m_vol(vol) {}
+        bool operator() (int k, Real v) const { return m_pre[k] - m_vol < v; }
+        const std::vector<Real>& m_pre;
+        Real                     m_vol;
+    };
+}
+
+//
+// Cuts the tokens, in curve order, into nprocs consecutive chunks of about
+// volpercpu each.  Each cut is a binary search over the prefix sums of the
+// volumes, so this is O(nprocs log N) after an O(N) scan.
+//
 static
 void
 Distribute (const std::vector<SFCToken>&     tokens,
@@ -1158,42 +1382,225 @@ Distribute (const std::vector<SFCToken>&     tokens,
 {
     BL_ASSERT(v.size() == nprocs);
 
+    const int TSZ = tokens.size();
+
+    std::vector<Real> pre(TSZ+1);
+    std::vector<int>  idx(TSZ+1);
+    pre[0] = 0;
+    for (int k = 0; k < TSZ; ++k)
+    {
+        pre[k+1] = pre[k] + tokens[k].m_vol;
+        idx[k]   = k;
+    }
+    idx[TSZ] = TSZ;
+
     int  K        = 0;
     Real totalvol = 0;
 
     for (int i = 0; i < nprocs; ++i)
     {
-        int  cnt = 0;
-        Real vol = 0;
+        //
+        // Take tokens until the chunk holds at least volpercpu; the last
+        // chunk takes all that are left.
+        //
+        int Kend = TSZ;
 
-        for ( int TSZ = tokens.size();
-              K < TSZ && (i == (nprocs-1) || vol < volpercpu);
-              ++cnt, ++K)
+        if (i < nprocs-1 && K < TSZ)
         {
-            vol += tokens[K].m_vol;
-
-            v[i].push_back(tokens[K].m_box);
+            std::vector<int>::const_iterator it =
+                std::lower_bound(idx.begin()+K+1, idx.end(), volpercpu, PrefixLess(pre, pre[K]));
+            if (it != idx.end())
+                Kend = *it;
+        }
+        else if (K == TSZ)
+        {
+            Kend = K;
         }
 
-        totalvol += vol;
+        const int cnt = Kend - K;
+
+        totalvol += pre[Kend] - pre[K];
 
         if ((totalvol/(i+1)) > volpercpu &&  // Too much for this bin.
             cnt > 1                      &&  // More than one box in this bin.
             i < nprocs-1)                    // Not the last bin, which has to take all.
         {
-            --K;
-            v[i].pop_back();
-            totalvol -= tokens[K].m_vol;
+            --Kend;
+            totalvol -= tokens[Kend].m_vol;
         }
+
+        v[i].reserve(Kend-K);
+        for ( ; K < Kend; ++K)
+            v[i].push_back(tokens[K].m_box);
     }
 
-#ifndef NDEBUG
-    int cnt = 0;
-    for (int i = 0; i < nprocs; ++i)
-        cnt += v[i].size();
-    BL_ASSERT(cnt == tokens.size());
-#endif
+    BL_ASSERT(K == TSZ);
+}
+
+#ifdef BL_USE_MPI
+namespace
+{
+    struct KeyedBox
+    {
+        unsigned long long key;
+        int                box;
+        long               wgt;
+
+        bool operator< (const KeyedBox& rhs) const
+        {
+            return key < rhs.key || (key == rhs.key && box < rhs.box);
+        }
+    };
+}
+
+//
+// Puts the boxes in Morton order in parallel.  Each process computes the
+// keys of a slice of the boxes, a sample sort orders them across the
+// processes, and the sorted slices are gathered on every process.  The
+// order is the one SFCToken::Compare gives.  Returns false, on every
+// process, if some index is negative or a key does not fit in 64 bits.
+// Collective.
+//
+static
+bool
+ParallelSFCSort (const BoxArray&          boxes,
+                 const std::vector<long>& wgts,
+                 std::vector<SFCToken>&   tokens)
+{
+    BL_PROFILE("DistributionMapping::ParallelSFCSort()");
+
+    const int  nprocs = ParallelDescriptor::NProcs();
+    const int  myproc = ParallelDescriptor::MyProc();
+    MPI_Comm   comm   = ParallelDescriptor::Communicator();
+    const long N      = boxes.size();
+    const int  ibegin = (N* myproc   )/nprocs;
+    const int  iend   = (N*(myproc+1))/nprocs;
+
+    int minijk = 0, maxijk = 0;
+    for (int i = ibegin; i < iend; ++i)
+    {
+        const IntVect iv = boxes[i].smallEnd();
+        for (int d = 0; d < BL_SPACEDIM; ++d)
+        {
+            minijk = std::min(minijk, iv[d]);
+            maxijk = std::max(maxijk, iv[d]);
+        }
+    }
+    ParallelDescriptor::ReduceIntMin(minijk);
+    ParallelDescriptor::ReduceIntMax(maxijk);
+
+    int m = 0;
+    for ( ; (1 << m) <= maxijk; ++m) {
+        ;  // do nothing
+    }
+
+    if (minijk < 0 || m*BL_SPACEDIM > 64)
+        return false;
+
+    SFCToken::MaxPower = m;
+    //
+    // Interleave the bits, most significant first and the last direction
+    // first within each level, to match SFCToken::Compare.
+    //
+    std::vector<KeyedBox> loc(iend-ibegin);
+    for (int i = ibegin; i < iend; ++i)
+    {
+        const IntVect iv = boxes[i].smallEnd();
+        unsigned long long key = 0;
+        for (int l = m-1; l >= 0; --l)
+            for (int d = BL_SPACEDIM-1; d >= 0; --d)
+                key = (key << 1) | ((iv[d] >> l) & 1);
+        KeyedBox& kb = loc[i-ibegin];
+        kb.key = key;
+        kb.box = i;
+        kb.wgt = wgts[i];
+    }
+    std::sort(loc.begin(), loc.end());
+    //
+    // Regular samples of the sorted slices give the bucket splitters.
+    //
+    const int ns = std::max(1L, std::min(long(nprocs-1), 16*N/(long(nprocs)*nprocs)));
+
+    KeyedBox sentinel;
+    sentinel.key = std::numeric_limits<unsigned long long>::max();
+    sentinel.box = std::numeric_limits<int>::max();
+    sentinel.wgt = 0;
+
+    std::vector<KeyedBox> samples(ns, sentinel), allsamples(long(ns)*nprocs);
+    const int nloc = loc.size();
+    for (int k = 0; k < ns && k < nloc; ++k)
+        samples[k] = loc[(long(k)*nloc)/ns];
+
+    BL_MPI_REQUIRE( MPI_Allgather(&samples[0], ns*sizeof(KeyedBox), MPI_BYTE,
+                                  &allsamples[0], ns*sizeof(KeyedBox), MPI_BYTE, comm) );
+
+    std::sort(allsamples.begin(), allsamples.end());
+
+    std::vector<KeyedBox> splitters(nprocs-1);
+    for (int k = 1; k < nprocs; ++k)
+        splitters[k-1] = allsamples[(long(k)*allsamples.size())/nprocs];
+    //
+    // Send each key to the process owning its bucket.
+    //
+    Array<int> sendcnt(nprocs), senddsp(nprocs), recvcnt(nprocs), recvdsp(nprocs);
+    {
+        int ilo = 0;
+        for (int p = 0; p < nprocs; ++p)
+        {
+            const int ihi = (p < nprocs-1)
+                ? std::lower_bound(loc.begin(), loc.end(), splitters[p]) - loc.begin()
+                : nloc;
+            sendcnt[p] = (ihi-ilo)*sizeof(KeyedBox);
+            senddsp[p] = ilo*sizeof(KeyedBox);
+            ilo = ihi;
+        }
+    }
+
+    BL_MPI_REQUIRE( MPI_Alltoall(sendcnt.dataPtr(), 1, MPI_INT,
+                                 recvcnt.dataPtr(), 1, MPI_INT, comm) );
+
+    int nrecv = 0;
+    for (int p = 0; p < nprocs; ++p)
+    {
+        recvdsp[p] = nrecv;
+        nrecv += recvcnt[p];
+    }
+
+    std::vector<KeyedBox> bucket(nrecv/sizeof(KeyedBox)+1);
+
+    BL_MPI_REQUIRE( MPI_Alltoallv(loc.empty() ? 0 : &loc[0], sendcnt.dataPtr(), senddsp.dataPtr(), MPI_BYTE,
+                                  &bucket[0], recvcnt.dataPtr(), recvdsp.dataPtr(), MPI_BYTE, comm) );
+
+    bucket.resize(nrecv/sizeof(KeyedBox));
+    std::sort(bucket.begin(), bucket.end());
+    //
+    // The buckets in process order are the sorted boxes.
+    //
+    int nbucket = bucket.size()*sizeof(KeyedBox);
+
+    BL_MPI_REQUIRE( MPI_Allgather(&nbucket, 1, MPI_INT, recvcnt.dataPtr(), 1, MPI_INT, comm) );
+
+    nrecv = 0;
+    for (int p = 0; p < nprocs; ++p)
+    {
+        recvdsp[p] = nrecv;
+        nrecv += recvcnt[p];
+    }
+    BL_ASSERT(nrecv == N*sizeof(KeyedBox));
+
+    std::vector<KeyedBox> sorted(N);
+
+    BL_MPI_REQUIRE( MPI_Allgatherv(bucket.empty() ? 0 : &bucket[0], nbucket, MPI_BYTE,
+                                   &sorted[0], recvcnt.dataPtr(), recvdsp.dataPtr(), MPI_BYTE, comm) );
+
+    tokens.clear();
+    tokens.reserve(N);
+    for (long i = 0; i < N; ++i)
+        tokens.push_back(SFCToken(sorted[i].box, boxes[sorted[i].box].smallEnd(), sorted[i].wgt));
+
+    return true;
 }
+#endif
 
 void
 DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
@@ -1226,32 +1633,42 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
 
     const int N = boxes.size();
 
-    tokens.reserve(N);
+    bool sorted = false;
 
-    int maxijk = 0;
+#ifdef BL_USE_MPI
+    if (N >= parallel_map_threshold && nprocs > 1 && ParallelDescriptor::NColors() == 1)
+        sorted = ParallelSFCSort(boxes, wgts, tokens);
+#endif
 
-    for (int i = 0; i < N; ++i)
+    if (!sorted)
     {
-        tokens.push_back(SFCToken(i,boxes[i].smallEnd(),wgts[i]));
+        tokens.reserve(N);
 
-        const SFCToken& token = tokens.back();
+        int maxijk = 0;
 
-        D_TERM(maxijk = std::max(maxijk, token.m_idx[0]);,
-               maxijk = std::max(maxijk, token.m_idx[1]);,
-               maxijk = std::max(maxijk, token.m_idx[2]););
-    }
-    //
-    // Set SFCToken::MaxPower for BoxArray.
-    //
-    int m = 0;
-    for ( ; (1 << m) <= maxijk; ++m) {
-        ;  // do nothing
+        for (int i = 0; i < N; ++i)
+        {
+            tokens.push_back(SFCToken(i,boxes[i].smallEnd(),wgts[i]));
+
+            const SFCToken& token = tokens.back();
+
+            D_TERM(maxijk = std::max(maxijk, token.m_idx[0]);,
+                   maxijk = std::max(maxijk, token.m_idx[1]);,
+                   maxijk = std::max(maxijk, token.m_idx[2]););
+        }
+        //
+        // Set SFCToken::MaxPower for BoxArray.
+        //
+        int m = 0;
+        for ( ; (1 << m) <= maxijk; ++m) {
+            ;  // do nothing
+        }
+        SFCToken::MaxPower = m;
+        //
+        // Put'm in Morton space filling curve order.
+        //
+        std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
     }
-    SFCToken::MaxPower = m;
-    //
-    // Put'm in Morton space filling curve order.
-    //
-    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
     //
     // Split'm up as equitably as possible per team.
     //
@@ -1262,11 +1679,838 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
 
     std::vector< std::vector<int> > vec(nteams);
 
-    Distribute(tokens,nteams,volperteam,vec);
+    Distribute(tokens,nteams,volperteam,vec);
+
+    // vec has a size of nteams and vec[] holds a vector of box ids.
+
+    tokens.clear();
+
+    std::vector<LIpair> LIpairV;
+
+    LIpairV.reserve(nteams);
+
+    for (int i = 0; i < nteams; ++i)
+    {
+	long wgt = 0;
+        const std::vector<int>& vi = vec[i];
+        for (int j = 0, M = vi.size(); j < M; ++j)
+            wgt += wgts[vi[j]];
+
+        LIpairV.push_back(LIpair(wgt,i));
+    }
+
+    Sort(LIpairV, true);
+
+    // LIpairV has a size of nteams and LIpairV[] is pair whose first is weight
+    // and second is an index into vec.  LIpairV is sorted by weight such that
+    // LIpairV is the heaviest.
+
+    Array<int> ord;
+    Array<Array<int> > wrkerord;
+
+    if (nteams == nprocs) {
+	LeastUsedCPUs(nprocs,ord);
+    } else {
+	LeastUsedTeams(ord,wrkerord,nteams,nworkers);
+    }
+
+    // ord is a vector of process (or team) ids, sorted from least used to more heavily used.
+    // wrkerord is a vector of sorted worker ids.
+
+    for (int i = 0; i < nteams; ++i)
+    {
+        const int tid  = ord[i];                  // tid is team id 
+        const int ivec = LIpairV[i].second;       // index into vec
+        const std::vector<int>& vi = vec[ivec];   // this vector contains boxes assigned to this team
+	const int Nbx = vi.size();                // # of boxes assigned to this team
+
+	if (nteams == nprocs) { // In this case, team id is process id.
+	    for (int j = 0; j < Nbx; ++j)
+	    {
+		m_ref->m_pmap[vi[j]] = ParallelDescriptor::Translate(tid,m_color);  
+	    }
+	} 
+	else   // We would like to do knapsack within the team workers
+	{
+	    std::vector<long> local_wgts;
+	    for (int j = 0; j < Nbx; ++j) {
+		local_wgts.push_back(wgts[vi[j]]);
+	    }
+
+	    std::vector<std::vector<int> > kpres;
+	    Real kpeff;
+	    knapsack(local_wgts, nworkers, kpres, kpeff, true, N+1);
+
+	    // kpres has a size of nworkers. kpres[] contains a vector of indices into vi. 
+
+	    // sort the knapsacked chunks
+	    std::vector<LIpair> ww;
+	    for (int w = 0; w < nworkers; ++w) {
+		long wgt = 0;
+		for (std::vector<int>::const_iterator it = kpres[w].begin();
+		     it != kpres[w].end(); ++it)
+		{
+		    wgt += local_wgts[*it];
+		}
+		ww.push_back(LIpair(wgt,w));
+	    }
+	    Sort(ww,true);
+
+	    // ww is a sorted vector of pair whose first is the weight and second is a index
+	    // into kpres.
+	    
+	    const Array<int>& sorted_workers = wrkerord[i];
+
+	    const int leadrank = tid * nworkers;
+
+	    for (int w = 0; w < nworkers; ++w)
+	    {
+		const int cpu = ParallelDescriptor::Translate(leadrank + sorted_workers[w], m_color);
+		int ikp = ww[w].second;
+		const std::vector<int>& js = kpres[ikp];
+		for (std::vector<int>::const_iterator it = js.begin(); it!=js.end(); ++it)
+		    m_ref->m_pmap[vi[*it]] = cpu;
+	    }
+	}
+    }
+    //
+    // Set sentinel equal to our processor number.
+    //
+    m_ref->m_pmap[boxes.size()] = ParallelDescriptor::MyProc();
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+    {
+        Real sum_wgt = 0, max_wgt = 0;
+        for (int i = 0; i < nteams; ++i)
+        {
+            const long W = LIpairV[i].first;
+            if (W > max_wgt)
+                max_wgt = W;
+            sum_wgt += W;
+        }
+
+        std::cout << "SFC efficiency: " << (sum_wgt/(nteams*max_wgt)) << '\n';
+    }
+}
+
+void
+DistributionMapping::SFCProcessorMap (const BoxArray& boxes,
+                                      int             nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+
+    if (m_ref->m_pmap.size() != boxes.size() + 1)
+    {
+        m_ref->m_pmap.resize(boxes.size()+1);
+    }
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(boxes,nprocs);
+    }
+    else
+    {
+        std::vector<long> wgts;
+
+        wgts.reserve(boxes.size());
+
+	for (int i = 0, N = boxes.size(); i < N; ++i)
+        {
+            wgts.push_back(boxes[i].volume());
+        }
+
+        SFCProcessorMapDoIt(boxes,wgts,nprocs);
+    }
+}
+
+void
+DistributionMapping::SFCProcessorMap (const BoxArray&          boxes,
+                                      const std::vector<long>& wgts,
+                                      int                      nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+    BL_ASSERT(boxes.size() == wgts.size());
+
+    if (m_ref->m_pmap.size() != wgts.size() + 1)
+    {
+        m_ref->m_pmap.resize(wgts.size()+1);
+    }
+
+    if (boxes.size() < sfc_threshold*nprocs)
+    {
+        KnapSackProcessorMap(wgts,nprocs);
+    }
+    else
+    {
+        SFCProcessorMapDoIt(boxes,wgts,nprocs);
+    }
+}
+
+void
+DistributionMapping::RRSFCDoIt (const BoxArray&          boxes,
+				int                      nprocs)
+{
+    BL_PROFILE("DistributionMapping::RRSFCDoIt()");
+
+#if defined (BL_USE_TEAM)
+    BoxLib::Abort("Team support is not implemented yet in RRSFC");
+#endif
+
+    if (ParallelDescriptor::NColors() > 1) 
+	BoxLib::Abort("RRSFCMap does not support multi colors");
+
+    std::vector<SFCToken> tokens;
+
+    const int nboxes = boxes.size();
+
+    tokens.reserve(nboxes);
+
+    int maxijk = 0;
+
+    for (int i = 0; i < nboxes; ++i)
+    {
+        tokens.push_back(SFCToken(i,boxes[i].smallEnd(),0.0));
+
+        const SFCToken& token = tokens.back();
+
+        D_TERM(maxijk = std::max(maxijk, token.m_idx[0]);,
+               maxijk = std::max(maxijk, token.m_idx[1]);,
+               maxijk = std::max(maxijk, token.m_idx[2]););
+    }
+    //
+    // Set SFCToken::MaxPower for BoxArray.
+    //
+    int m = 0;
+    for ( ; (1 << m) <= maxijk; ++m) {
+        ;  // do nothing
+    }
+    SFCToken::MaxPower = m;
+    //
+    // Put'm in Morton space filling curve order.
+    //
+    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
+
+    Array<int> ord;
+
+    LeastUsedCPUs(nprocs,ord);
+
+    // Distribute boxes using roundrobin
+    for (int i = 0; i < nboxes; ++i) {
+	m_ref->m_pmap[i] = ord[i%nprocs];
+    }
+    //
+    // Set sentinel equal to our processor number.
+    //
+    m_ref->m_pmap[nboxes] = ParallelDescriptor::MyProc();
+}
+
+void
+DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
+                                        int                      nprocs)
+{
+    BL_ASSERT(boxes.size() > 0);
+ 
+    if (m_ref->m_pmap.size() != boxes.size() + 1)
+    {
+        m_ref->m_pmap.resize(boxes.size() + 1);
+    }
+
+    RRSFCDoIt(boxes,nprocs);
+}
+
+namespace
+{
+    //
+    // The box adjacency graph in compressed row form.  The vertex weights
+    // are the box weights.  The weight of edge (i,j) is the number of
+    // ghost cells box i fills from box j plus the number box j fills from
+    // box i, i.e. the cells a FillBoundary moves between them.
+    //
+    struct CommGraph
+    {
+        std::vector<int>  xadj;
+        std::vector<int>  adjncy;
+        std::vector<long> adjwgt;
+        std::vector<long> vwgt;
+
+        int nvtx () const { return vwgt.size(); }
+
+        long totalWeight () const
+            { return std::accumulate(vwgt.begin(), vwgt.end(), 0L); }
+    };
+
+    struct GraphEdge
+    {
+        GraphEdge (int u, int v, long w) : m_u(u), m_v(v), m_w(w) {}
+
+        bool operator< (const GraphEdge& rhs) const
+            { return m_u < rhs.m_u || (m_u == rhs.m_u && m_v < rhs.m_v); }
+
+        int  m_u;
+        int  m_v;
+        long m_w;
+    };
+    //
+    // Builds the CSR arrays of g out of an edge list.
+    // The weights of duplicate edges are summed.
+    //
+    void
+    MakeCSR (int                     n,
+             std::vector<GraphEdge>& edges,
+             CommGraph&              g)
+    {
+        std::sort(edges.begin(), edges.end());
+
+        g.xadj.assign(n+1, 0);
+        g.adjncy.clear();
+        g.adjwgt.clear();
+
+        for (std::size_t e = 0, M = edges.size(); e < M; )
+        {
+            const int u = edges[e].m_u;
+            const int v = edges[e].m_v;
+            long      w = 0;
+            for ( ; e < M && edges[e].m_u == u && edges[e].m_v == v; ++e)
+                w += edges[e].m_w;
+            g.adjncy.push_back(v);
+            g.adjwgt.push_back(w);
+            g.xadj[u+1]++;
+        }
+
+        for (int i = 0; i < n; ++i)
+            g.xadj[i+1] += g.xadj[i];
+    }
+
+    void
+    BuildCommGraph (const BoxArray&          boxes,
+                    const std::vector<long>& wgts,
+                    int                      ngrow,
+                    CommGraph&               g)
+    {
+        BL_PROFILE("BuildCommGraph()");
+
+        const int N = boxes.size();
+
+        Array<Box> gboxes(N);
+        for (int i = 0; i < N; ++i)
+            gboxes[i] = BoxLib::grow(boxes[i], ngrow);
+
+        Array< std::vector< std::pair<int,Box> > > isects;
+        boxes.intersections(gboxes, isects);
+
+        std::vector<GraphEdge> edges;
+        for (int i = 0; i < N; ++i)
+        {
+            for (int k = 0, M = isects[i].size(); k < M; ++k)
+            {
+                const int j = isects[i][k].first;
+                if (j == i) continue;
+                const long w = isects[i][k].second.numPts();
+                edges.push_back(GraphEdge(i,j,w));
+                edges.push_back(GraphEdge(j,i,w));
+            }
+        }
+
+        MakeCSR(N, edges, g);
+
+        g.vwgt = wgts;
+    }
+    //
+    // The subgraph induced by verts.  loc must be -1 everywhere on entry
+    // and is left that way.
+    //
+    void
+    Subgraph (const CommGraph&        g,
+              const std::vector<int>& verts,
+              std::vector<int>&       loc,
+              CommGraph&              sub)
+    {
+        const int n = verts.size();
+
+        for (int i = 0; i < n; ++i)
+            loc[verts[i]] = i;
+
+        sub.xadj.assign(n+1, 0);
+        sub.adjncy.clear();
+        sub.adjwgt.clear();
+        sub.vwgt.resize(n);
+
+        for (int i = 0; i < n; ++i)
+        {
+            const int u = verts[i];
+            sub.vwgt[i] = g.vwgt[u];
+            for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+            {
+                const int v = loc[g.adjncy[e]];
+                if (v >= 0)
+                {
+                    sub.adjncy.push_back(v);
+                    sub.adjwgt.push_back(g.adjwgt[e]);
+                }
+            }
+            sub.xadj[i+1] = sub.adjncy.size();
+        }
+
+        for (int i = 0; i < n; ++i)
+            loc[verts[i]] = -1;
+    }
+
+    long
+    EdgeCut (const CommGraph&        g,
+             const std::vector<int>& part)
+    {
+        long cut = 0;
+        for (int u = 0, n = g.nvtx(); u < n; ++u)
+            for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+                if (part[u] != part[g.adjncy[e]])
+                    cut += g.adjwgt[e];
+        return cut/2;
+    }
+    //
+    // Heavy-edge matching: each vertex is paired with the unmatched
+    // neighbor it shares the most ghost cells with, as long as the pair
+    // weighs no more than maxvwgt.  Vertices of low degree go first so
+    // they still find a partner.  Returns the number of coarse vertices;
+    // cmap maps the vertices of g onto them.
+    //
+    int
+    MatchHeavyEdges (const CommGraph&  g,
+                     long              maxvwgt,
+                     std::vector<int>& cmap)
+    {
+        const int n = g.nvtx();
+
+        std::vector< std::pair<int,int> > order(n);
+        for (int u = 0; u < n; ++u)
+            order[u] = std::make_pair(g.xadj[u+1]-g.xadj[u], u);
+        std::sort(order.begin(), order.end());
+
+        std::vector<int> match(n, -1);
+
+        for (int k = 0; k < n; ++k)
+        {
+            const int u = order[k].second;
+            if (match[u] >= 0) continue;
+
+            int  best = u;
+            long bestw = 0;
+            for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+            {
+                const int v = g.adjncy[e];
+                if (match[v] < 0 && g.adjwgt[e] > bestw && g.vwgt[u] + g.vwgt[v] <= maxvwgt)
+                {
+                    best  = v;
+                    bestw = g.adjwgt[e];
+                }
+            }
+            match[u]    = best;
+            match[best] = u;
+        }
+
+        cmap.resize(n);
+
+        int nc = 0;
+        for (int u = 0; u < n; ++u)
+        {
+            if (u <= match[u])
+            {
+                cmap[u] = cmap[match[u]] = nc++;
+            }
+        }
+
+        return nc;
+    }
+
+    void
+    Contract (const CommGraph&        g,
+              const std::vector<int>& cmap,
+              int                     nc,
+              CommGraph&              cg)
+    {
+        std::vector<GraphEdge> edges;
+        edges.reserve(g.adjncy.size());
+
+        cg.vwgt.assign(nc, 0);
+
+        for (int u = 0, n = g.nvtx(); u < n; ++u)
+        {
+            const int cu = cmap[u];
+            cg.vwgt[cu] += g.vwgt[u];
+            for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+            {
+                const int cv = cmap[g.adjncy[e]];
+                if (cv != cu)
+                    edges.push_back(GraphEdge(cu,cv,g.adjwgt[e]));
+            }
+        }
+
+        MakeCSR(nc, edges, cg);
+    }
+    //
+    // Splits g in two by growing region 0 from a seed vertex until it
+    // weighs about target, always adding the frontier vertex that cuts the
+    // fewest edges.  Several seeds are tried and the smallest cut among
+    // the best balanced splits is kept.
+    //
+    void
+    Bisect (const CommGraph&   g,
+            long               target,
+            std::vector<char>& side)
+    {
+        const int n = g.nvtx();
+        const int ntrials = std::min(n, 4);
+
+        std::vector<long> wdeg(n, 0);
+        for (int u = 0; u < n; ++u)
+            for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+                wdeg[u] += g.adjwgt[e];
+        //
+        // The first seed is the vertex farthest (in hops) from vertex 0.
+        //
+        int seed0 = 0;
+        {
+            std::vector<int> dist(n, -1);
+            std::queue<int>  q;
+            q.push(0);
+            dist[0] = 0;
+            while (!q.empty())
+            {
+                const int u = q.front();
+                q.pop();
+                seed0 = u;
+                for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+                {
+                    const int v = g.adjncy[e];
+                    if (dist[v] < 0)
+                    {
+                        dist[v] = dist[u] + 1;
+                        q.push(v);
+                    }
+                }
+            }
+        }
+
+        long bestcut = -1, besterr = 0;
+
+        std::vector<char> trial(n);
+        std::vector<long> gain(n);
+
+        for (int t = 0; t < ntrials; ++t)
+        {
+            const int seed = (t == 0) ? seed0 : (long(t)*n)/ntrials;
+
+            trial.assign(n, 1);
+            for (int u = 0; u < n; ++u)
+                gain[u] = -wdeg[u];
+
+            std::priority_queue< std::pair<long,int> > pq;
+            pq.push(std::make_pair(gain[seed], seed));
+
+            long wA = 0;
+            int  next = 0;
+
+            while (wA < target)
+            {
+                if (pq.empty())
+                {
+                    //
+                    // Disconnected: continue in another component.
+                    //
+                    while (next < n && trial[next] == 0)
+                        ++next;
+                    if (next == n) break;
+                    pq.push(std::make_pair(gain[next], next));
+                }
+
+                const std::pair<long,int> top = pq.top();
+                pq.pop();
+
+                const int u = top.second;
+                if (trial[u] == 0 || top.first != gain[u]) continue;
+
+                if (wA > 0 && wA + g.vwgt[u] - target > target - wA) break;
+
+                trial[u] = 0;
+                wA += g.vwgt[u];
+
+                for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+                {
+                    const int v = g.adjncy[e];
+                    if (trial[v])
+                    {
+                        gain[v] += 2*g.adjwgt[e];
+                        pq.push(std::make_pair(gain[v], v));
+                    }
+                }
+            }
+
+            long cut = 0;
+            for (int u = 0; u < n; ++u)
+                for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+                    if (trial[u] && !trial[g.adjncy[e]])
+                        cut += g.adjwgt[e];
+
+            const long err = std::abs(wA - target);
+
+            if (bestcut < 0 || err < besterr || (err == besterr && cut < bestcut))
+            {
+                bestcut = cut;
+                besterr = err;
+                side    = trial;
+            }
+        }
+    }
+
+    void
+    RecursiveBisection (const CommGraph&        g,
+                        const std::vector<int>& gid,
+                        int                     nparts,
+                        int                     part0,
+                        std::vector<int>&       part)
+    {
+        const int n = g.nvtx();
+
+        if (n == 0) return;
+
+        if (nparts == 1)
+        {
+            for (int u = 0; u < n; ++u)
+                part[gid[u]] = part0;
+            return;
+        }
+
+        const int  nleft  = nparts/2;
+        const long target = long(double(g.totalWeight())*nleft/nparts + 0.5);
+
+        std::vector<char> side;
+        Bisect(g, target, side);
+
+        std::vector<int> verts[2];
+        for (int u = 0; u < n; ++u)
+            verts[int(side[u])].push_back(u);
+
+        std::vector<int> loc(n, -1);
+
+        for (int s = 0; s < 2; ++s)
+        {
+            CommGraph sub;
+            Subgraph(g, verts[s], loc, sub);
+
+            std::vector<int> subgid(verts[s].size());
+            for (int i = 0, M = verts[s].size(); i < M; ++i)
+                subgid[i] = gid[verts[s][i]];
+
+            if (s == 0)
+                RecursiveBisection(sub, subgid, nleft, part0, part);
+            else
+                RecursiveBisection(sub, subgid, nparts-nleft, part0+nleft, part);
+        }
+    }
+    //
+    // Greedy k-way refinement: moves boundary vertices to the neighboring
+    // part that gains the most, without pushing that part over maxpw.
+    // Moves that do not change the cut but even out the load are also
+    // taken, and vertices of overweight parts are moved out even if that
+    // adds to the cut.
+    //
+    void
+    RefineKWay (const CommGraph&  g,
+                int               nparts,
+                long              maxpw,
+                int               npasses,
+                std::vector<int>& part)
+    {
+        const int n = g.nvtx();
+
+        std::vector<long> pw(nparts, 0);
+        for (int u = 0; u < n; ++u)
+            pw[part[u]] += g.vwgt[u];
+
+        std::vector<long> conn(nparts, 0);
+        std::vector<int>  touched;
+
+        for (int pass = 0; pass < npasses; ++pass)
+        {
+            int nmoved = 0;
+
+            for (int u = 0; u < n; ++u)
+            {
+                const int  pu = part[u];
+                const long w  = g.vwgt[u];
+
+                touched.clear();
+                for (int e = g.xadj[u]; e < g.xadj[u+1]; ++e)
+                {
+                    const int p = part[g.adjncy[e]];
+                    if (conn[p] == 0)
+                        touched.push_back(p);
+                    conn[p] += g.adjwgt[e];
+                }
+
+                const long internal = conn[pu];
+                const bool over     = pw[pu] > maxpw;
+
+                int  best     = -1;
+                long bestgain = 0;
+
+                for (int k = 0, M = touched.size(); k < M; ++k)
+                {
+                    const int p = touched[k];
+                    if (p == pu || pw[p] + w > maxpw) continue;
+
+                    const long gain = conn[p] - internal;
+
+                    const bool ok = over || gain > 0 || (gain == 0 && pw[p] + w < pw[pu]);
+
+                    if (ok && (best < 0 || gain > bestgain || (gain == bestgain && pw[p] < pw[best])))
+                    {
+                        best     = p;
+                        bestgain = gain;
+                    }
+                }
+
+                for (int k = 0, M = touched.size(); k < M; ++k)
+                    conn[touched[k]] = 0;
+
+                if (over && best < 0)
+                {
+                    //
+                    // No neighbor has room: move to the lightest part.
+                    //
+                    const int p = std::min_element(pw.begin(), pw.end()) - pw.begin();
+                    if (pw[p] + w <= maxpw)
+                        best = p;
+                }
+
+                if (best >= 0)
+                {
+                    pw[pu]   -= w;
+                    pw[best] += w;
+                    part[u]   = best;
+                    ++nmoved;
+                }
+            }
+
+            if (nmoved == 0) break;
+        }
+    }
+    //
+    // Multilevel k-way partitioning: the graph is coarsened by heavy-edge
+    // matching, the coarsest graph is split by recursive bisection, and the
+    // partition is refined on every level on the way back.  No part may
+    // weigh more than (1+imbalance) times the average, or the heaviest
+    // vertex if that is more.
+    //
+    void
+    PartitionGraph (const CommGraph&  graph,
+                    int               nparts,
+                    Real              imbalance,
+                    std::vector<int>& part)
+    {
+        BL_PROFILE("PartitionGraph()");
+
+        const int n = graph.nvtx();
+
+        part.assign(n, 0);
+
+        if (nparts <= 1 || n == 0) return;
+
+        const long W     = graph.totalWeight();
+        const long maxvw = *std::max_element(graph.vwgt.begin(), graph.vwgt.end());
+        const long maxpw = std::max(long((1+imbalance)*double(W)/nparts), maxvw);
+        //
+        // Coarsen until there are about 16 vertices per part.
+        //
+        const int  coarsen_to = std::max(16*nparts, 64);
+        const long maxmatch   = std::max(long(1.5*double(W)/coarsen_to), maxvw);
+
+        std::vector<CommGraph>          graphs(1, graph);
+        std::vector< std::vector<int> > cmaps;
+
+        while (graphs.back().nvtx() > coarsen_to)
+        {
+            std::vector<int> cmap;
+            const int nc = MatchHeavyEdges(graphs.back(), maxmatch, cmap);
+            if (nc > 0.95*graphs.back().nvtx()) break;
+
+            CommGraph cg;
+            Contract(graphs.back(), cmap, nc, cg);
+
+            cmaps.push_back(cmap);
+            graphs.push_back(cg);
+        }
+
+        const int nlev = graphs.size();
+
+        std::vector<int> cpart(graphs.back().nvtx());
+        {
+            std::vector<int> gid(graphs.back().nvtx());
+            for (int u = 0, M = gid.size(); u < M; ++u)
+                gid[u] = u;
+            RecursiveBisection(graphs.back(), gid, nparts, 0, cpart);
+        }
+        RefineKWay(graphs.back(), nparts, maxpw, 8, cpart);
+
+        for (int lev = nlev-2; lev >= 0; --lev)
+        {
+            const std::vector<int>& cmap = cmaps[lev];
+            std::vector<int> fpart(cmap.size());
+            for (int u = 0, M = cmap.size(); u < M; ++u)
+                fpart[u] = cpart[cmap[u]];
+            RefineKWay(graphs[lev], nparts, maxpw, 8, fpart);
+            cpart.swap(fpart);
+            graphs.pop_back();
+        }
+
+        part.swap(cpart);
+    }
+}
+
+void
+DistributionMapping::GraphProcessorMapDoIt (const BoxArray&          boxes,
+                                            const std::vector<long>& wgts,
+                                            int                   /*   nprocs */)
+{
+    BL_PROFILE("DistributionMapping::GraphProcessorMapDoIt()");
+
+    int nprocs = ParallelDescriptor::NProcs(m_color);
+
+    int nteams = nprocs;
+    int nworkers = 1;
+#if defined(BL_USE_TEAM)
+    nteams = ParallelDescriptor::NTeams();
+    nworkers = ParallelDescriptor::TeamSize();
+    if (ParallelDescriptor::NColors() > 1) 
+	BoxLib::Abort("Team and color together are not supported yet");
+#else
+    if (node_size > 0) {
+	nteams = nprocs/node_size;
+	nworkers = node_size;
+	if (nworkers*nteams != nprocs) {
+	    nteams = nprocs;
+	    nworkers = 1;
+	}
+    }
+#endif
+
+    const int N = boxes.size();
+
+    CommGraph graph;
+    BuildCommGraph(boxes, wgts, graph_ngrow, graph);
+    //
+    // Partition over the teams (nodes) first so that it is the inter-node
+    // traffic that is minimized, then split each team's part over its
+    // workers.  The allowed imbalance is shared between the two levels.
+    //
+    const Real imbalance = (nworkers > 1) ? graph_imbalance/2 : graph_imbalance;
+
+    std::vector<int> tpart;
+    PartitionGraph(graph, nteams, imbalance, tpart);
 
-    // vec has a size of nteams and vec[] holds a vector of box ids.
+    std::vector< std::vector<int> > vec(nteams);
 
-    tokens.clear();
+    for (int i = 0; i < N; ++i)
+        vec[tpart[i]].push_back(i);
 
     std::vector<LIpair> LIpairV;
 
@@ -1284,10 +2528,6 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
 
     Sort(LIpairV, true);
 
-    // LIpairV has a size of nteams and LIpairV[] is pair whose first is weight
-    // and second is an index into vec.  LIpairV is sorted by weight such that
-    // LIpairV is the heaviest.
-
     Array<int> ord;
     Array<Array<int> > wrkerord;
 
@@ -1297,88 +2537,76 @@ DistributionMapping::SFCProcessorMapDoIt (const BoxArray&          boxes,
 	LeastUsedTeams(ord,wrkerord,nteams,nworkers);
     }
 
-    // ord is a vector of process (or team) ids, sorted from least used to more heavily used.
-    // wrkerord is a vector of sorted worker ids.
+    std::vector<int> loc(nteams == nprocs ? 0 : N, -1);
 
     for (int i = 0; i < nteams; ++i)
     {
-        const int tid  = ord[i];                  // tid is team id 
-        const int ivec = LIpairV[i].second;       // index into vec
-        const std::vector<int>& vi = vec[ivec];   // this vector contains boxes assigned to this team
-	const int Nbx = vi.size();                // # of boxes assigned to this team
+        const int tid  = ord[i];
+        const std::vector<int>& vi = vec[LIpairV[i].second];
+	const int Nbx = vi.size();
 
-	if (nteams == nprocs) { // In this case, team id is process id.
+	if (nteams == nprocs)
+        {
 	    for (int j = 0; j < Nbx; ++j)
-	    {
-		m_ref->m_pmap[vi[j]] = ParallelDescriptor::Translate(tid,m_color);  
-	    }
+		m_ref->m_pmap[vi[j]] = ParallelDescriptor::Translate(tid,m_color);
 	} 
-	else   // We would like to do knapsack within the team workers
+	else
 	{
-	    std::vector<long> local_wgts;
-	    for (int j = 0; j < Nbx; ++j) {
-		local_wgts.push_back(wgts[vi[j]]);
-	    }
-
-	    std::vector<std::vector<int> > kpres;
-	    Real kpeff;
-	    knapsack(local_wgts, nworkers, kpres, kpeff, true, N+1);
+            CommGraph sub;
+            Subgraph(graph, vi, loc, sub);
 
-	    // kpres has a size of nworkers. kpres[] contains a vector of indices into vi. 
+            std::vector<int> wpart;
+            PartitionGraph(sub, nworkers, imbalance, wpart);
 
-	    // sort the knapsacked chunks
-	    std::vector<LIpair> ww;
-	    for (int w = 0; w < nworkers; ++w) {
-		long wgt = 0;
-		for (std::vector<int>::const_iterator it = kpres[w].begin();
-		     it != kpres[w].end(); ++it)
-		{
-		    wgt += local_wgts[*it];
-		}
-		ww.push_back(LIpair(wgt,w));
-	    }
+	    std::vector<LIpair> ww(nworkers);
+	    for (int w = 0; w < nworkers; ++w)
+                ww[w] = LIpair(0,w);
+            for (int j = 0; j < Nbx; ++j)
+                ww[wpart[j]].first += wgts[vi[j]];
 	    Sort(ww,true);
 
-	    // ww is a sorted vector of pair whose first is the weight and second is a index
-	    // into kpres.
-	    
 	    const Array<int>& sorted_workers = wrkerord[i];
 
 	    const int leadrank = tid * nworkers;
 
+            std::vector<int> cpu(nworkers);
 	    for (int w = 0; w < nworkers; ++w)
-	    {
-		const int cpu = ParallelDescriptor::Translate(leadrank + sorted_workers[w], m_color);
-		int ikp = ww[w].second;
-		const std::vector<int>& js = kpres[ikp];
-		for (std::vector<int>::const_iterator it = js.begin(); it!=js.end(); ++it)
-		    m_ref->m_pmap[vi[*it]] = cpu;
-	    }
+		cpu[ww[w].second] = ParallelDescriptor::Translate(leadrank + sorted_workers[w], m_color);
+
+            for (int j = 0; j < Nbx; ++j)
+                m_ref->m_pmap[vi[j]] = cpu[wpart[j]];
 	}
     }
     //
     // Set sentinel equal to our processor number.
     //
-    m_ref->m_pmap[boxes.size()] = ParallelDescriptor::MyProc();
+    m_ref->m_pmap[N] = ParallelDescriptor::MyProc();
 
     if (verbose && ParallelDescriptor::IOProcessor())
     {
+        std::vector<long> wgt(ParallelDescriptor::NProcs(), 0);
+        for (int i = 0; i < N; ++i)
+            wgt[m_ref->m_pmap[i]] += wgts[i];
+
         Real sum_wgt = 0, max_wgt = 0;
-        for (int i = 0; i < nteams; ++i)
+        for (int i = 0, M = wgt.size(); i < M; ++i)
         {
-            const long W = LIpairV[i].first;
-            if (W > max_wgt)
-                max_wgt = W;
-            sum_wgt += W;
+            max_wgt = std::max(max_wgt, Real(wgt[i]));
+            sum_wgt += wgt[i];
         }
 
-        std::cout << "SFC efficiency: " << (sum_wgt/(nteams*max_wgt)) << '\n';
+        std::vector<int> ppart(m_ref->m_pmap.begin(), m_ref->m_pmap.end()-1);
+
+        std::cout << "GRAPH efficiency: " << (sum_wgt/(nprocs*max_wgt))
+                  << ", halo cells cut: " << EdgeCut(graph,ppart)
+                  << " between processes, " << EdgeCut(graph,tpart)
+                  << " between teams\n";
     }
 }
 
 void
-DistributionMapping::SFCProcessorMap (const BoxArray& boxes,
-                                      int             nprocs)
+DistributionMapping::GraphProcessorMap (const BoxArray& boxes,
+                                        int             nprocs)
 {
     BL_ASSERT(boxes.size() > 0);
 
@@ -1402,14 +2630,14 @@ DistributionMapping::SFCProcessorMap (const BoxArray& boxes,
             wgts.push_back(boxes[i].volume());
         }
 
-        SFCProcessorMapDoIt(boxes,wgts,nprocs);
+        GraphProcessorMapDoIt(boxes,wgts,nprocs);
     }
 }
 
 void
-DistributionMapping::SFCProcessorMap (const BoxArray&          boxes,
-                                      const std::vector<long>& wgts,
-                                      int                      nprocs)
+DistributionMapping::GraphProcessorMap (const BoxArray&          boxes,
+                                        const std::vector<long>& wgts,
+                                        int                      nprocs)
 {
     BL_ASSERT(boxes.size() > 0);
     BL_ASSERT(boxes.size() == wgts.size());
@@ -1425,80 +2653,8 @@ DistributionMapping::SFCProcessorMap (const BoxArray&          boxes,
     }
     else
     {
-        SFCProcessorMapDoIt(boxes,wgts,nprocs);
-    }
-}
-
-void
-DistributionMapping::RRSFCDoIt (const BoxArray&          boxes,
-				int                      nprocs)
-{
-    BL_PROFILE("DistributionMapping::RRSFCDoIt()");
-
-#if defined (BL_USE_TEAM)
-    BoxLib::Abort("Team support is not implemented yet in RRSFC");
-#endif
-
-    if (ParallelDescriptor::NColors() > 1) 
-	BoxLib::Abort("RRSFCMap does not support multi colors");
-
-    std::vector<SFCToken> tokens;
-
-    const int nboxes = boxes.size();
-
-    tokens.reserve(nboxes);
-
-    int maxijk = 0;
-
-    for (int i = 0; i < nboxes; ++i)
-    {
-        tokens.push_back(SFCToken(i,boxes[i].smallEnd(),0.0));
-
-        const SFCToken& token = tokens.back();
-
-        D_TERM(maxijk = std::max(maxijk, token.m_idx[0]);,
-               maxijk = std::max(maxijk, token.m_idx[1]);,
-               maxijk = std::max(maxijk, token.m_idx[2]););
-    }
-    //
-    // Set SFCToken::MaxPower for BoxArray.
-    //
-    int m = 0;
-    for ( ; (1 << m) <= maxijk; ++m) {
-        ;  // do nothing
-    }
-    SFCToken::MaxPower = m;
-    //
-    // Put'm in Morton space filling curve order.
-    //
-    std::sort(tokens.begin(), tokens.end(), SFCToken::Compare());
-
-    Array<int> ord;
-
-    LeastUsedCPUs(nprocs,ord);
-
-    // Distribute boxes using roundrobin
-    for (int i = 0; i < nboxes; ++i) {
-	m_ref->m_pmap[i] = ord[i%nprocs];
-    }
-    //
-    // Set sentinel equal to our processor number.
-    //
-    m_ref->m_pmap[nboxes] = ParallelDescriptor::MyProc();
-}
-
-void
-DistributionMapping::RRSFCProcessorMap (const BoxArray&          boxes,
-                                        int                      nprocs)
-{
-    BL_ASSERT(boxes.size() > 0);
- 
-    if (m_ref->m_pmap.size() != boxes.size() + 1)
-    {
-        m_ref->m_pmap.resize(boxes.size() + 1);
+        GraphProcessorMapDoIt(boxes,wgts,nprocs);
     }
-
-    RRSFCDoIt(boxes,nprocs);
 }
 
 namespace
@@ -2877,39 +4033,238 @@ DistributionMapping::TranslateProcMap(const Array<int> &pm_old, const MPI_Group
 DistributionMapping
 DistributionMapping::makeKnapSack (const MultiFab& weight)
 {
-    DistributionMapping r;
+    Array<Real> cost(weight.size(), 0.0);
 
-    Array<long> cost(weight.size());
-#if BL_USE_MPI
-    {
-	Array<Real> rcost(cost.size(), 0.0);
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-	for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
-	    int i = mfi.index();
-	    rcost[i] = weight[mfi].sum(mfi.validbox(),0);
-	}
+    for (MFIter mfi(weight); mfi.isValid(); ++mfi) {
+	int i = mfi.index();
+	cost[i] = weight[mfi].sum(mfi.validbox(),0);
+    }
 
-	ParallelDescriptor::ReduceRealSum(&rcost[0], rcost.size());
+    ParallelDescriptor::ReduceRealSum(cost.dataPtr(), cost.size());
 
-	Real wmax = *std::max_element(rcost.begin(), rcost.end());
-	Real scale = 1.e9/wmax;
-	
-	for (int i = 0; i < rcost.size(); ++i) {
-	    cost[i] = long(cost[i]*scale) + 1L;
-	}
+    return makeKnapSack(cost);
+}
+
+namespace
+{
+    //
+    // The knapsack and SFC algorithms work on integer weights.
+    //
+    void
+    CostToWeights (const Array<Real>& cost, std::vector<long>& wgts)
+    {
+        wgts.resize(cost.size());
+
+        const Real wmax = cost.empty() ? 0 : *std::max_element(cost.begin(), cost.end());
+        const Real scale = (wmax > 0) ? 1.e9/wmax : 0;
+
+        for (int i = 0, N = cost.size(); i < N; ++i)
+            wgts[i] = long(cost[i]*scale) + 1L;
     }
-#endif
+}
+
+DistributionMapping
+DistributionMapping::makeKnapSack (const Array<Real>& cost,
+                                   Real*              efficiency)
+{
+    DistributionMapping r;
+
+    std::vector<long> wgts;
+    CostToWeights(cost, wgts);
+
+    r.KnapSackProcessorMap(wgts, ParallelDescriptor::NProcs(), efficiency, true);
+
+    return r;
+}
+
+DistributionMapping
+DistributionMapping::makeSFC (const BoxArray&    boxes,
+                              const Array<Real>& cost)
+{
+    BL_ASSERT(boxes.size() == cost.size());
+
+    DistributionMapping r;
 
-    int nprocs = ParallelDescriptor::NProcs();
-    Real eff;
+    std::vector<long> wgts;
+    CostToWeights(cost, wgts);
 
-    r.KnapSackProcessorMap(cost, nprocs, &eff, true);
+    r.SFCProcessorMap(boxes, wgts, ParallelDescriptor::NProcs());
 
     return r;
 }
 
+Real
+DistributionMapping::efficiency (const Array<Real>& cost) const
+{
+    BL_ASSERT(size() == cost.size()+1);
+
+    Array<Real> wgt(ParallelDescriptor::NProcs(), 0.0);
+
+    for (int i = 0, N = cost.size(); i < N; ++i)
+        wgt[(*this)[i]] += cost[i];
+
+    const Real wmax = *std::max_element(wgt.begin(), wgt.end());
+    const Real wsum = std::accumulate(wgt.begin(), wgt.end(), Real(0));
+
+    return (wmax > 0) ? wsum/(wgt.size()*wmax) : 1;
+}
+
+long
+DistributionMapping::haloCells (const BoxArray& boxes,
+                                int             ngrow,
+                                int             ranks_per_node) const
+{
+    BL_ASSERT(size() == boxes.size()+1);
+    BL_ASSERT(ranks_per_node > 0);
+
+    const int N = boxes.size();
+
+    Array<Box> gboxes(N);
+    for (int i = 0; i < N; ++i)
+        gboxes[i] = BoxLib::grow(boxes[i], ngrow);
+
+    Array< std::vector< std::pair<int,Box> > > isects;
+    boxes.intersections(gboxes, isects);
+
+    long ncells = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        const int inode = (*this)[i] / ranks_per_node;
+        for (int k = 0, M = isects[i].size(); k < M; ++k)
+        {
+            if ((*this)[isects[i][k].first] / ranks_per_node != inode)
+                ncells += isects[i][k].second.numPts();
+        }
+    }
+
+    return ncells;
+}
+
+bool
+DistributionMapping::Rebalance (const BoxArray&            boxes,
+                                const DistributionMapping& dm,
+                                const Array<Real>&         cost,
+                                long                       bytes_per_cell,
+                                int                        nsteps,
+                                DistributionMapping&       newdm)
+{
+    BL_PROFILE("DistributionMapping::Rebalance()");
+
+    BL_ASSERT(boxes.size() == cost.size());
+    BL_ASSERT(dm.size() == boxes.size()+1);
+
+    const DistributionMapping cand = (m_Strategy == SFC) ? makeSFC(boxes, cost)
+                                                         : makeKnapSack(cost);
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    Array<Real> oldwgt(nprocs, 0.0), newwgt(nprocs, 0.0), moved(nprocs, 0.0);
+
+    for (int i = 0, N = cost.size(); i < N; ++i)
+    {
+        oldwgt[dm[i]]   += cost[i];
+        newwgt[cand[i]] += cost[i];
+
+        if (dm[i] != cand[i])
+        {
+            //
+            // Both the sender and the receiver pay for the move.
+            //
+            const Real b = Real(boxes[i].numPts()) * bytes_per_cell;
+            moved[dm[i]]   += b;
+            moved[cand[i]] += b;
+        }
+    }
+
+    const Real told  = *std::max_element(oldwgt.begin(), oldwgt.end());
+    const Real tnew  = *std::max_element(newwgt.begin(), newwgt.end());
+    const Real tmove = *std::max_element(moved.begin(), moved.end()) / lb_bandwidth;
+    const Real gain  = (told - tnew) * nsteps;
+
+    const bool remap = gain > tmove;
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "DistributionMapping::Rebalance: efficiency "
+                  << dm.efficiency(cost) << " -> " << cand.efficiency(cost)
+                  << ", time saved " << gain << " s over " << nsteps
+                  << " steps, time to move " << tmove << " s"
+                  << (remap ? ", remapping" : ", keeping the old map") << '\n';
+    }
+
+    if (remap)
+        newdm = cand;
+
+    return remap;
+}
+
+MeasuredCost::MeasuredCost ()
+    :
+    m_nsteps(0)
+{}
+
+MeasuredCost::MeasuredCost (int nboxes)
+    :
+    m_nsteps(0)
+{
+    define(nboxes);
+}
+
+void
+MeasuredCost::define (int nboxes)
+{
+    m_step.resize(nboxes);
+    m_cost.resize(nboxes);
+    reset();
+}
+
+void
+MeasuredCost::reset ()
+{
+    std::fill(m_step.begin(), m_step.end(), 0.0);
+    std::fill(m_cost.begin(), m_cost.end(), 0.0);
+    m_nsteps = 0;
+}
+
+void
+MeasuredCost::endStep ()
+{
+    //
+    // An exponential moving average with the same mean age as a
+    // cost_window-step running mean.
+    //
+    const Real alpha = (m_nsteps == 0) ? 1.0 : 2.0/(cost_window+1);
+
+    for (int i = 0, N = m_step.size(); i < N; ++i)
+    {
+        m_cost[i] = alpha*m_step[i] + (1.0-alpha)*m_cost[i];
+        m_step[i] = 0;
+    }
+
+    ++m_nsteps;
+}
+
+void
+MeasuredCost::globalCost (Array<Real>& cost) const
+{
+    cost = m_cost;
+    ParallelDescriptor::ReduceRealSum(cost.dataPtr(), cost.size());
+}
+
+MeasuredCost::Timer::Timer (MeasuredCost& cost, int i)
+    :
+    m_cost(cost),
+    m_i(i),
+    m_t0(ParallelDescriptor::second())
+{}
+
+MeasuredCost::Timer::~Timer ()
+{
+    m_cost.add(m_i, ParallelDescriptor::second() - m_t0);
+}
+
 std::ostream&
 operator<< (std::ostream&              os,
             const DistributionMapping& pmap)
@@ -3,10 +3,13 @@
 #include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <cfloat>
 #include <cmath>
 #include <cstring>
 #include <limits>
+#include <vector>
+#include <string>
 
 #include <FArrayBox.H>
 #include <FabConv.H>
@@ -43,6 +46,8 @@ static const char sys_name[] = "IEEE";
 //
 FABio::Ordering FArrayBox::ordering = FABio::FAB_NORMAL_ORDER;
 
+Real FArrayBox::compress_tol = 0;
+
 //
 // Our 8-bit FABio type.
 //
@@ -132,6 +137,51 @@ private:
     CpClassPtr<RealDescriptor> rd;
 };
 
+//
+// Our compressed FABio type.  The data of a FAB starts with a line giving
+// for each component its coding, error bound and size in bytes; the read
+// and skip functions walk through the components in order.
+//
+class FABio_compressed
+    :
+    public FABio
+{
+public:
+    FABio_compressed ();
+
+    virtual void read (std::istream& is,
+                       FArrayBox&    fb) const BL_OVERRIDE;
+
+    virtual void write (std::ostream&    os,
+                        const FArrayBox& fb,
+                        int              comp,
+                        int              num_comp) const BL_OVERRIDE;
+
+    virtual void skip (std::istream& is,
+                       FArrayBox&    f) const BL_OVERRIDE;
+
+    virtual void skip (std::istream& is,
+                       FArrayBox&    f,
+		       int           nCompToSkip) const BL_OVERRIDE;
+
+private:
+    virtual void write_header (std::ostream&    os,
+                               const FArrayBox& f,
+                               int              nvar) const BL_OVERRIDE;
+
+    void read_table (std::istream& is) const;
+
+    void skip_comps (std::istream& is,
+                     int           ncomp) const;
+    //
+    // The table read from the stream, and the next component in it.
+    //
+    mutable std::vector<int>  m_mode;
+    mutable std::vector<Real> m_eb;
+    mutable std::vector<long> m_size;
+    mutable int               m_next;
+};
+
 //
 // This isn't inlined as it's virtual.
 //
@@ -185,6 +235,32 @@ FArrayBox::initVal ()
     }
 }
 
+void
+FArrayBox::initVal (const Box& bx)
+{
+    if (init_snan) {
+#ifdef BL_USE_DOUBLE
+	//
+	// One row at a time, since bx is not contiguous in memory.
+	//
+	Box rows(bx);
+	rows.setBig(0, bx.smallEnd(0));
+	const long len = bx.length(0);
+	for (int n = 0; n < nvar; ++n) {
+	    for (IntVect iv = rows.smallEnd(); iv <= rows.bigEnd(); rows.next(iv)) {
+		array_init_snan(&((*this)(iv,n)), len);
+	    }
+	}
+#else
+	setVal(0.0, bx, 0, nvar);
+#endif
+    } else if (do_initval) {
+	setVal(initval, bx, 0, nvar);
+    } else {
+	setVal(0.0, bx, 0, nvar);
+    }
+}
+
 bool 
 FArrayBox::contains_nan () const
 {
@@ -381,6 +457,9 @@ FArrayBox::setFormat (FABio::Format fmt)
     case FABio::FAB_NATIVE_32:
         fio = new FABio_binary(FPC::Native32RealDescriptor().clone());
         break;
+    case FABio::FAB_COMPRESSED:
+        fio = new FABio_compressed;
+        break;
     default:
         std::cerr << "FArrayBox::setFormat(): Bad FABio::Format = " << fmt;
         BoxLib::Abort();
@@ -418,6 +497,19 @@ FArrayBox::getPrecision ()
     return FABio::FAB_FLOAT;
 }
 
+void
+FArrayBox::setCompressTol (Real tol)
+{
+    BL_ASSERT(tol >= 0);
+    compress_tol = tol;
+}
+
+Real
+FArrayBox::getCompressTol ()
+{
+    return compress_tol;
+}
+
 bool
 FArrayBox::set_do_initval (bool tf)
 {
@@ -497,6 +589,11 @@ FArrayBox::Initialize ()
             }
             fio = new FABio_binary(FPC::Ieee32NormalRealDescriptor().clone());
         }
+        else if (fmt == "COMPRESSED")
+        {
+            FArrayBox::format = FABio::FAB_COMPRESSED;
+            fio = new FABio_compressed;
+        }
         else
         {
             std::cerr << "FArrayBox::init(): Bad FABio::Format = " << fmt;
@@ -543,6 +640,12 @@ FArrayBox::Initialize ()
     pp.query("do_initval", do_initval);
     pp.query("init_snan", init_snan);
 
+    pp.query("compress_tol", compress_tol);
+
+    bool cxx_kernels = BoxLib::FabCxxKernels();
+    if (pp.query("cxx_kernels", cxx_kernels))
+        BoxLib::SetFabCxxKernels(cxx_kernels);
+
     BoxLib::ExecOnFinalize(FArrayBox::Finalize);
 }
 
@@ -602,6 +705,11 @@ FABio::read_header (std::istream& is,
         {
         case FABio::FAB_ASCII: fio = new FABio_ascii; break;
         case FABio::FAB_8BIT:  fio = new FABio_8bit;  break;
+        case FABio::FAB_COMPRESSED:
+            if (wrd_in != sizeof(Real))
+                BoxLib::Error("FABio::read_header(): FAB_COMPRESSED of other precision");
+            fio = new FABio_compressed;
+            break;
         case FABio::FAB_NATIVE:
         case FABio::FAB_NATIVE_32:
         case FABio::FAB_IEEE:
@@ -684,6 +792,11 @@ FABio::read_header (std::istream& is,
         {
         case FABio::FAB_ASCII: fio = new FABio_ascii; break;
         case FABio::FAB_8BIT:  fio = new FABio_8bit;  break;
+        case FABio::FAB_COMPRESSED:
+            if (wrd_in != sizeof(Real))
+                BoxLib::Error("FABio::read_header(): FAB_COMPRESSED of other precision");
+            fio = new FABio_compressed;
+            break;
         case FABio::FAB_NATIVE:
         case FABio::FAB_NATIVE_32:
         case FABio::FAB_IEEE:
@@ -1041,6 +1154,364 @@ FABio_binary::skip (std::istream& is,
         BoxLib::Error("FABio_binary::skip(..., int nCompToSkip) failed");
 }
 
+namespace
+{
+    //
+    // The FAB_COMPRESSED coding.  Each value of a component becomes a word:
+    // losslessly the XOR of its bits with those of the previous value, or
+    // with an error bound eb the zigzag-coded number of 2*eb steps from the
+    // previous reconstructed value.  Both leave mostly zero high bytes for
+    // smooth data.  The words are split into byte planes, most significant
+    // first, and each plane is run-length coded: a control byte c < 128 is
+    // followed by c+1 literal bytes, otherwise by one byte repeated c-126
+    // times.
+    //
+#ifdef BL_USE_FLOAT
+    typedef unsigned int       FabWord;
+#else
+    typedef unsigned long long FabWord;
+#endif
+
+    const int NPlanes = sizeof(FabWord);
+
+    enum { Lossless = 0, Quantized = 1 };
+
+    void
+    PackBytes (const unsigned char* src,
+               long                 n,
+               std::string&         out)
+    {
+        long i = 0;
+
+        while (i < n)
+        {
+            long run = 1;
+            while (i + run < n && run < 129 && src[i+run] == src[i])
+                ++run;
+
+            if (run >= 3)
+            {
+                out += char(run + 126);
+                out += char(src[i]);
+                i   += run;
+            }
+            else
+            {
+                long j = i + 1;
+                while (j < n && j - i < 128 &&
+                       !(j + 2 < n && src[j] == src[j+1] && src[j] == src[j+2]))
+                    ++j;
+
+                out += char(j - i - 1);
+                out.append(reinterpret_cast<const char*>(src + i), j - i);
+                i = j;
+            }
+        }
+    }
+    //
+    // Returns the end of the n bytes' coding, or 0 if it's corrupt.
+    //
+    const char*
+    UnpackBytes (const char*    p,
+                 const char*    end,
+                 unsigned char* dst,
+                 long           n)
+    {
+        long i = 0;
+
+        while (i < n)
+        {
+            if (p >= end) return 0;
+
+            const int c = static_cast<unsigned char>(*p++);
+
+            if (c < 128)
+            {
+                const long len = c + 1;
+                if (i + len > n || p + len > end) return 0;
+                std::memcpy(dst + i, p, len);
+                p += len;
+                i += len;
+            }
+            else
+            {
+                const long len = c - 126;
+                if (i + len > n || p >= end) return 0;
+                std::memset(dst + i, static_cast<unsigned char>(*p++), len);
+                i += len;
+            }
+        }
+
+        return p;
+    }
+    //
+    // Codes n values; returns the coding used, which is Lossless when eb
+    // isn't positive or some value can't be quantized to within eb.
+    //
+    int
+    CompressComp (const Real*  dat,
+                  long         n,
+                  Real         eb,
+                  std::string& out)
+    {
+        std::vector<FabWord> w(n);
+
+        int mode = (eb > 0) ? Quantized : Lossless;
+
+        if (mode == Quantized)
+        {
+            const Real step = 2*eb;
+            const Real qmax = Real(FabWord(1) << (8*NPlanes-2));
+            Real       pred = 0;
+
+            for (long i = 0; i < n; ++i)
+            {
+                const Real d = std::floor((dat[i] - pred) / step + Real(0.5));
+
+                if (!(std::fabs(d) < qmax))
+                {
+                    mode = Lossless;
+                    break;
+                }
+
+                const long long q = static_cast<long long>(d);
+                const Real      r = pred + step * Real(q);
+
+                if (!(std::fabs(r - dat[i]) <= eb))
+                {
+                    mode = Lossless;
+                    break;
+                }
+
+                w[i] = (q < 0) ? ((FabWord(-q) << 1) - 1) : (FabWord(q) << 1);
+                pred = r;
+            }
+        }
+
+        if (mode == Lossless)
+        {
+            FabWord prev = 0;
+
+            for (long i = 0; i < n; ++i)
+            {
+                FabWord b;
+                std::memcpy(&b, dat + i, sizeof(FabWord));
+                w[i] = b ^ prev;
+                prev = b;
+            }
+        }
+
+        std::vector<unsigned char> plane(n);
+
+        for (int ip = NPlanes-1; ip >= 0; --ip)
+        {
+            for (long i = 0; i < n; ++i)
+                plane[i] = static_cast<unsigned char>(w[i] >> (8*ip));
+
+            PackBytes(n > 0 ? &plane[0] : 0, n, out);
+        }
+
+        return mode;
+    }
+
+    bool
+    DecompressComp (const char* p,
+                    long        nbytes,
+                    int         mode,
+                    Real        eb,
+                    Real*       dat,
+                    long        n)
+    {
+        const char* end = p + nbytes;
+
+        std::vector<FabWord>       w(n, 0);
+        std::vector<unsigned char> plane(n);
+
+        for (int ip = NPlanes-1; ip >= 0; --ip)
+        {
+            if (n > 0 && (p = UnpackBytes(p, end, &plane[0], n)) == 0)
+                return false;
+
+            for (long i = 0; i < n; ++i)
+                w[i] |= FabWord(plane[i]) << (8*ip);
+        }
+
+        if (mode == Quantized)
+        {
+            const Real step = 2*eb;
+            Real       pred = 0;
+
+            for (long i = 0; i < n; ++i)
+            {
+                const long long q = (w[i] & 1) ? -static_cast<long long>((w[i] + 1) >> 1)
+                                               :  static_cast<long long>(w[i] >> 1);
+                pred   = pred + step * Real(q);
+                dat[i] = pred;
+            }
+        }
+        else if (mode == Lossless)
+        {
+            FabWord prev = 0;
+
+            for (long i = 0; i < n; ++i)
+            {
+                prev ^= w[i];
+                std::memcpy(dat + i, &prev, sizeof(FabWord));
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        return p == end;
+    }
+}
+
+FABio_compressed::FABio_compressed ()
+    :
+    m_next(0)
+{}
+
+void
+FABio_compressed::write_header (std::ostream&    os,
+                                const FArrayBox& f,
+                                int              nvar) const
+{
+    os << "FAB: "
+       << FABio::FAB_COMPRESSED
+       << ' '
+       << sizeof(Real)
+       << ' '
+       << sys_name
+       << '\n';
+    FABio::write_header(os, f, nvar);
+}
+
+void
+FABio_compressed::write (std::ostream&    os,
+                         const FArrayBox& f,
+                         int              comp,
+                         int              num_comp) const
+{
+    BL_ASSERT(comp >= 0 && num_comp >= 1 && (comp+num_comp) <= f.nComp());
+
+    const long siz = f.box().numPts();
+    const Real tol = FArrayBox::getCompressTol();
+
+    std::vector<std::string> data(num_comp);
+
+    std::ostringstream table;
+
+    table.precision(std::numeric_limits<Real>::digits10 + 3);
+
+    table << num_comp;
+
+    for (int k = 0; k < num_comp; k++)
+    {
+        const Real eb   = (tol > 0) ? tol * (f.max(k+comp) - f.min(k+comp)) : 0;
+        const int  mode = CompressComp(f.dataPtr(k+comp), siz, eb, data[k]);
+
+        table << ' ' << mode << ' ' << (mode == Quantized ? eb : 0) << ' ' << data[k].size();
+    }
+
+    os << table.str() << '\n';
+
+    for (int k = 0; k < num_comp; k++)
+        os.write(data[k].data(), data[k].size());
+
+    if (os.fail())
+        BoxLib::Error("FABio_compressed::write() failed");
+}
+
+void
+FABio_compressed::read_table (std::istream& is) const
+{
+    if (!m_size.empty()) return;
+
+    int ncomp = 0;
+    is >> ncomp;
+
+    if (is.fail() || ncomp < 1)
+        BoxLib::Error("FABio_compressed::read_table() failed");
+
+    m_mode.resize(ncomp);
+    m_eb.resize(ncomp);
+    m_size.resize(ncomp);
+
+    for (int k = 0; k < ncomp; k++)
+        is >> m_mode[k] >> m_eb[k] >> m_size[k];
+
+    is.ignore(BL_IGNORE_MAX, '\n');
+
+    if (is.fail())
+        BoxLib::Error("FABio_compressed::read_table() failed");
+
+    m_next = 0;
+}
+
+void
+FABio_compressed::read (std::istream& is,
+                        FArrayBox&    f) const
+{
+    read_table(is);
+
+    if (m_next + f.nComp() > int(m_size.size()))
+        BoxLib::Error("FABio_compressed::read(): not enough components");
+
+    const long siz = f.box().numPts();
+
+    std::vector<char> buf;
+
+    for (int k = 0; k < f.nComp(); k++, m_next++)
+    {
+        buf.resize(m_size[m_next] + 1);
+
+        is.read(&buf[0], m_size[m_next]);
+
+        if (is.fail() || !DecompressComp(&buf[0], m_size[m_next], m_mode[m_next],
+                                         m_eb[m_next], f.dataPtr(k), siz))
+            BoxLib::Error("FABio_compressed::read() failed");
+    }
+}
+
+void
+FABio_compressed::skip_comps (std::istream& is,
+                              int           ncomp) const
+{
+    read_table(is);
+
+    if (m_next + ncomp > int(m_size.size()))
+        BoxLib::Error("FABio_compressed::skip(): not enough components");
+
+    long nbytes = 0;
+
+    for (int k = 0; k < ncomp; k++, m_next++)
+        nbytes += m_size[m_next];
+
+    is.seekg(nbytes, std::ios::cur);
+
+    if (is.fail())
+        BoxLib::Error("FABio_compressed::skip() failed");
+}
+
+void
+FABio_compressed::skip (std::istream& is,
+                        FArrayBox&    f) const
+{
+    read_table(is);
+
+    skip_comps(is, m_size.size() - m_next);
+}
+
+void
+FABio_compressed::skip (std::istream& is,
+                        FArrayBox&    f,
+		        int           nCompToSkip) const
+{
+    skip_comps(is, nCompToSkip);
+}
+
 std::ostream&
 operator<< (std::ostream&    os,
             const FArrayBox& f)
@@ -20,6 +20,9 @@
 // Set default values in Initialize()!!!
 //
 bool    FabArrayBase::do_async_sends;
+bool    FabArrayBase::fb_persistent;
+bool    FabArrayBase::first_touch;
+long    FabArrayBase::cache_max_bytes;
 int     FabArrayBase::MaxComp;
 #if BL_SPACEDIM == 1
 IntVect FabArrayBase::mfiter_tile_size(1024000);
@@ -38,11 +41,19 @@ FabArrayBase::FBCache              FabArrayBase::m_TheFBCache;
 FabArrayBase::CPCache              FabArrayBase::m_TheCPCache;
 FabArrayBase::FPinfoCache          FabArrayBase::m_TheFillPatchCache;
 
+MPI_Comm                           FabArrayBase::m_fb_persistent_comm   = MPI_COMM_NULL;
+MPI_Comm                           FabArrayBase::m_fb_persistent_parent = MPI_COMM_NULL;
+int                                FabArrayBase::m_fb_persistent_tag    = 0;
+std::set<int>                      FabArrayBase::m_fb_persistent_free_tags;
+
 FabArrayBase::CacheStats           FabArrayBase::m_TAC_stats("TileArrayCache");
 FabArrayBase::CacheStats           FabArrayBase::m_FBC_stats("FBCache");
 FabArrayBase::CacheStats           FabArrayBase::m_CPC_stats("CopyCache");
 FabArrayBase::CacheStats           FabArrayBase::m_FPinfo_stats("FillPatchCache");
 
+long                               FabArrayBase::m_cache_clock = 0L;
+int                                FabArrayBase::m_TAC_nactive = 0;
+
 std::map<FabArrayBase::BDKey, int> FabArrayBase::m_BD_count;
 
 FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
@@ -50,6 +61,98 @@ FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
 namespace
 {
     bool initialized = false;
+
+    struct DstIndexLess
+    {
+	explicit DstIndexLess (const Array<const FabArrayBase::CopyComTag*>& tags)
+	    : m_tags(tags) {}
+	bool operator() (int i, int j) const {
+	    return m_tags[i]->dstIndex < m_tags[j]->dstIndex;
+	}
+	const Array<const FabArrayBase::CopyComTag*>& m_tags;
+    };
+
+    //
+    // A cache entry that evictCaches() may erase.
+    //
+    struct CacheItem
+    {
+	enum Kind { TA = 0, FB, CPC, FP };
+	long                   lastuse;
+	Kind                   kind;
+	const void*            ptr;
+	FabArrayBase::BDKey    bdkey;
+	std::pair<IntVect,int> takey;  // FabArrayBase::TAKey is protected
+	bool operator< (const CacheItem& rhs) const { return lastuse < rhs.lastuse; }
+    };
+
+    //
+    // Removes the entry of cache with the given key that points to p.
+    //
+    template <class Cache, class T>
+    void EraseCacheEntry (Cache& cache, const FabArrayBase::BDKey& key, const T* p)
+    {
+	std::pair<typename Cache::iterator, typename Cache::iterator> er_it = cache.equal_range(key);
+	for (typename Cache::iterator it = er_it.first; it != er_it.second; ++it) {
+	    if (it->second == p) {
+		cache.erase(it);
+		return;
+	    }
+	}
+    }
+
+    //
+    // Chops the cell-centered bx into tiles of roughly tileSize, appends
+    // them to tiles and returns how many there are.  A zero tileSize
+    // means no tiling.
+    //
+    int TileBox (const Box& bx, const IntVect& tileSize, Array<Box>& tiles)
+    {
+	if (tileSize == IntVect::TheZeroVector()) {
+	    tiles.push_back(bx);
+	    return 1;
+	}
+
+	IntVect nt_in_fab, tsize, nleft;
+	int ntiles = 1;
+	for (int d=0; d<BL_SPACEDIM; d++) {
+	    int ncells = bx.length(d);
+	    nt_in_fab[d] = std::max(ncells/tileSize[d], 1);
+	    tsize    [d] = ncells/nt_in_fab[d];
+	    nleft    [d] = ncells - nt_in_fab[d]*tsize[d];
+	    ntiles *= nt_in_fab[d];
+	}
+
+	IntVect small, big, ijk;  // note that the initial values are all zero.
+	ijk[0] = -1;
+	for (int t = 0; t < ntiles; ++t) {
+	    for (int d=0; d<BL_SPACEDIM; d++) {
+		if (ijk[d]<nt_in_fab[d]-1) {
+		    ijk[d]++;
+		    break;
+		} else {
+		    ijk[d] = 0;
+		}
+	    }
+
+	    for (int d=0; d<BL_SPACEDIM; d++) {
+		if (ijk[d] < nleft[d]) {
+		    small[d] = ijk[d]*(tsize[d]+1);
+		    big[d] = small[d] + tsize[d];
+		} else {
+		    small[d] = ijk[d]*tsize[d] + nleft[d];
+		    big[d] = small[d] + tsize[d] - 1;
+		}
+	    }
+
+	    Box tbx(small, big, IndexType::TheCellType());
+	    tbx.shift(bx.smallEnd());
+
+	    tiles.push_back(tbx);
+	}
+
+	return ntiles;
+    }
 }
 
 
@@ -75,6 +178,9 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::do_async_sends    = true;
+    FabArrayBase::fb_persistent     = false;
+    FabArrayBase::first_touch       = false;
+    FabArrayBase::cache_max_bytes   = -1L;
     FabArrayBase::MaxComp           = 25;
 
     ParmParse pp("fabarray");
@@ -98,10 +204,30 @@ FabArrayBase::Initialize ()
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
     pp.query("do_async_sends",      FabArrayBase::do_async_sends);
+    pp.query("fb_persistent",       FabArrayBase::fb_persistent);
+    pp.query("first_touch",         FabArrayBase::first_touch);
+
+    double cache_max_mb = -1.0;
+    if (pp.query("cache_max_mb", cache_max_mb) && cache_max_mb >= 0.0)
+	FabArrayBase::cache_max_bytes = static_cast<long>(cache_max_mb*1024.0*1024.0);
 
     if (MaxComp < 1)
         MaxComp = 1;
 
+#if defined(BL_USE_MPI) && !defined(BL_USE_UPCXX)
+    if (FabArrayBase::fb_persistent && ParallelDescriptor::NProcs() > 1)
+    {
+	//
+	// Persistent requests live on their own communicator so that their
+	// fixed tags can never match a message using ParallelDescriptor::SeqNum().
+	//
+	m_fb_persistent_parent = ParallelDescriptor::Communicator();
+	BL_MPI_REQUIRE( MPI_Comm_dup(m_fb_persistent_parent, &m_fb_persistent_comm) );
+	m_fb_persistent_tag = 0;
+	m_fb_persistent_free_tags.clear();
+    }
+#endif
+
     FabArrayBase::nFabArrays = 0;
 
     BoxLib::ExecOnFinalize(FabArrayBase::Finalize);
@@ -151,6 +277,77 @@ FabArrayBase::bytesOfMapOfCopyComTagContainers (const FabArrayBase::MapOfCopyCom
     return r;
 }
 
+void
+FabArrayBase::CopyComWork::define (const CopyComTagsContainer& tags)
+{
+    const int N = tags.size();
+
+    m_tags.resize(N);
+    m_buf.resize(N, 0);
+    m_offset.resize(N, 0L);
+
+    for (int i = 0; i < N; ++i)
+	m_tags[i] = &tags[i];
+
+    defineGroups();
+}
+
+void
+FabArrayBase::CopyComWork::define (const MapOfCopyComTagContainers& tags)
+{
+    m_tags.clear();
+    m_buf.clear();
+    m_offset.clear();
+
+    //
+    // Messages are packed in the order of the map and each message holds
+    // its tags back to back.
+    //
+    int ibuf = 0;
+    for (MapOfCopyComTagContainers::const_iterator m_it = tags.begin();
+	 m_it != tags.end(); ++m_it, ++ibuf)
+    {
+	long offset = 0;
+	for (CopyComTagsContainer::const_iterator it = m_it->second.begin();
+	     it != m_it->second.end(); ++it)
+	{
+	    m_tags.push_back(&(*it));
+	    m_buf.push_back(ibuf);
+	    m_offset.push_back(offset);
+	    offset += it->dbox.numPts();
+	}
+    }
+
+    defineGroups();
+}
+
+void
+FabArrayBase::CopyComWork::defineGroups ()
+{
+    const int N = m_tags.size();
+
+    m_order.resize(N);
+    for (int i = 0; i < N; ++i)
+	m_order[i] = i;
+
+    // A stable sort keeps the original order within each destination FAB.
+    std::stable_sort(m_order.begin(), m_order.end(), DstIndexLess(m_tags));
+
+    m_group.clear();
+    for (int j = 0; j < N; ++j) {
+	if (j == 0 || m_tags[m_order[j]]->dstIndex != m_tags[m_order[j-1]]->dstIndex)
+	    m_group.push_back(j);
+    }
+    m_group.push_back(N);
+}
+
+long
+FabArrayBase::CopyComWork::bytes () const
+{
+    return BoxLib::bytesOf(m_tags) + BoxLib::bytesOf(m_buf) + BoxLib::bytesOf(m_offset)
+	+  BoxLib::bytesOf(m_order) + BoxLib::bytesOf(m_group);
+}
+
 long
 FabArrayBase::CPC::bytes () const
 {
@@ -171,13 +368,15 @@ FabArrayBase::CPC::bytes () const
     if (m_RcvVols)
 	cnt += BoxLib::bytesOf(*m_RcvVols);
 
+    cnt += m_LocWork.bytes() + m_SndWork.bytes() + m_RcvWork.bytes();
+
     return cnt;
 }
 
 long
 FabArrayBase::FB::bytes () const
 {
-    int cnt = sizeof(FabArrayBase::FB);
+    long cnt = sizeof(FabArrayBase::FB);
 
     if (m_LocTags)
 	cnt += BoxLib::bytesOf(*m_LocTags);
@@ -194,6 +393,8 @@ FabArrayBase::FB::bytes () const
     if (m_RcvVols)
 	cnt += BoxLib::bytesOf(*m_RcvVols);
 
+    cnt += m_LocWork.bytes() + m_SndWork.bytes() + m_RcvWork.bytes();
+
     return cnt;
 }
 
@@ -279,20 +480,29 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
 	const int nlocal_dst = imap_dst.size();
 	const int ng_dst = m_dstng;
 
-	std::vector< std::pair<int,Box> > isects;
-
 	const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
+	const int nshifts = pshifts.size();
+
+	Array<Box> qbxs;
+	Array< std::vector< std::pair<int,Box> > > qisects;
+
+	qbxs.reserve(nlocal_src*nshifts);
+	for (int i = 0; i < nlocal_src; ++i) {
+	    const Box& bx_src = BoxLib::grow(ba_src[imap_src[i]], ng_src);
+	    for (int ip = 0; ip < nshifts; ++ip)
+		qbxs.push_back(bx_src+pshifts[ip]);
+	}
+	ba_dst.intersections(qbxs, qisects, ng_dst);
 
 	CopyComTag::MapOfCopyComTagContainers send_tags; // temp copy
 	
-	for (int i = 0; i < nlocal_src; ++i)
+	for (int i = 0, iq = 0; i < nlocal_src; ++i)
 	{
 	    const int   k_src = imap_src[i];
-	    const Box& bx_src = BoxLib::grow(ba_src[k_src], ng_src);
 
 	    for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
 	    {
-		ba_dst.intersections(bx_src+(*pit), isects, false, ng_dst);
+		const std::vector< std::pair<int,Box> >& isects = qisects[iq++];
 	    
 		for (int j = 0, M = isects.size(); j < M; ++j)
 		{
@@ -323,8 +533,17 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
 	if (ParallelDescriptor::TeamSize() > 1) {
 	    check_local = true;
 	}
+
+	qbxs.clear();
+	qbxs.reserve(nlocal_dst*nshifts);
+	for (int i = 0; i < nlocal_dst; ++i) {
+	    const Box& bx_dst = BoxLib::grow(ba_dst[imap_dst[i]], ng_dst);
+	    for (int ip = 0; ip < nshifts; ++ip)
+		qbxs.push_back(bx_dst+pshifts[ip]);
+	}
+	ba_src.intersections(qbxs, qisects, ng_src);
 	
-	for (int i = 0; i < nlocal_dst; ++i)
+	for (int i = 0, iq = 0; i < nlocal_dst; ++i)
 	{
 	    const int   k_dst = imap_dst[i];
 	    const Box& bx_dst = BoxLib::grow(ba_dst[k_dst], ng_dst);
@@ -341,7 +560,7 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
 	    
 	    for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
 	    {
-		ba_src.intersections(bx_dst+(*pit), isects, false, ng_src);
+		const std::vector< std::pair<int,Box> >& isects = qisects[iq++];
 	    
 		for (int j = 0, M = isects.size(); j < M; ++j)
 		{
@@ -422,6 +641,10 @@ FabArrayBase::CPC::define (const BoxArray& ba_dst, const DistributionMapping& dm
 	    }
 	}    
     }
+
+    m_LocWork.define(*m_LocTags);
+    m_SndWork.define(*m_SndTags);
+    m_RcvWork.define(*m_RcvTags);
 }
 
 void
@@ -452,9 +675,7 @@ FabArrayBase::flushCPC (bool no_assertion) const
 	    }
 	}
 
-#ifdef BL_MEM_PROFILING
 	m_CPC_stats.bytes -= it->second->bytes();
-#endif
 	m_CPC_stats.recordErase(it->second->m_nuse);
 	delete it->second;
     }
@@ -479,9 +700,7 @@ FabArrayBase::flushCPCache ()
 	}
     }
     m_TheCPCache.clear();
-#ifdef BL_MEM_PROFILING
     m_CPC_stats.bytes = 0L;
-#endif
 }
 
 const FabArrayBase::CPC&
@@ -509,6 +728,7 @@ FabArrayBase::getCPC (int dstng, const FabArrayBase& src, int srcng, const Perio
 	    it->second->m_dstba  == boxArray())
 	{
 	    ++(it->second->m_nuse);
+	    it->second->m_lastuse = m_CPC_stats.lastuse = ++m_cache_clock;
 	    m_CPC_stats.recordUse();
 	    return *(it->second);
 	}
@@ -517,12 +737,10 @@ FabArrayBase::getCPC (int dstng, const FabArrayBase& src, int srcng, const Perio
     // Have to build a new one
     CPC* new_cpc = new CPC(*this, dstng, src, srcng, period);
 
-#ifdef BL_MEM_PROFILING
-    m_CPC_stats.bytes += new_cpc->bytes();
-    m_CPC_stats.bytes_hwm = std::max(m_CPC_stats.bytes_hwm, m_CPC_stats.bytes);
-#endif    
+    m_CPC_stats.recordBytes(new_cpc->bytes());
 
     new_cpc->m_nuse = 1;
+    new_cpc->m_lastuse = m_CPC_stats.lastuse = ++m_cache_clock;
     m_CPC_stats.recordBuild();
     m_CPC_stats.recordUse();
 
@@ -530,6 +748,8 @@ FabArrayBase::getCPC (int dstng, const FabArrayBase& src, int srcng, const Perio
     if (srckey != dstkey)
 	m_TheCPCache.insert(          CPCache::value_type(srckey,new_cpc));
 
+    evictCaches();
+
     return *new_cpc;
 }
 
@@ -559,6 +779,10 @@ FabArrayBase::FB::FB (const FabArrayBase& fa, bool cross, const Periodicity& per
 	    define_fb(fa);
 	}
     }
+
+    m_LocWork.define(*m_LocTags);
+    m_SndWork.define(*m_SndTags);
+    m_RcvWork.define(*m_RcvTags);
 }
 
 void
@@ -577,20 +801,30 @@ FabArrayBase::FB::define_fb(const FabArrayBase& fa)
     const int nlocal = imap.size();
     const int ng = m_ngrow;
     const IndexType& typ = ba.ixType();
-    std::vector< std::pair<int,Box> > isects;
     
     const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
+    const int nshifts = pshifts.size();
+
+    Array<Box> qbxs;
+    Array< std::vector< std::pair<int,Box> > > qisects;
+
+    qbxs.reserve(nlocal*nshifts);
+    for (int i = 0; i < nlocal; ++i) {
+	const Box& vbx = ba[imap[i]];
+	for (int ip = 0; ip < nshifts; ++ip)
+	    qbxs.push_back(vbx+pshifts[ip]);
+    }
+    ba.intersections(qbxs, qisects, ng);
     
     CopyComTag::MapOfCopyComTagContainers send_tags; // temp copy
     
-    for (int i = 0; i < nlocal; ++i)
+    for (int i = 0, iq = 0; i < nlocal; ++i)
     {
 	const int ksnd = imap[i];
-	const Box& vbx = ba[ksnd];
 	
 	for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
 	{
-	    ba.intersections(vbx+(*pit), isects, false, ng);
+	    const std::vector< std::pair<int,Box> >& isects = qisects[iq++];
 
 	    for (int j = 0, M = isects.size(); j < M; ++j)
 	    {
@@ -630,8 +864,16 @@ FabArrayBase::FB::define_fb(const FabArrayBase& fa)
 	check_local = false;
 	check_remote = false;
     }
+
+    qbxs.clear();
+    for (int i = 0; i < nlocal; ++i) {
+	const Box& bxrcv = BoxLib::grow(ba[imap[i]], ng);
+	for (int ip = 0; ip < nshifts; ++ip)
+	    qbxs.push_back(bxrcv+pshifts[ip]);
+    }
+    ba.intersections(qbxs, qisects);
     
-    for (int i = 0; i < nlocal; ++i)
+    for (int i = 0, iq = 0; i < nlocal; ++i)
     {
 	const int   krcv = imap[i];
 	const Box& vbx   = ba[krcv];
@@ -649,7 +891,7 @@ FabArrayBase::FB::define_fb(const FabArrayBase& fa)
 	
 	for (std::vector<IntVect>::const_iterator pit=pshifts.begin(); pit!=pshifts.end(); ++pit)
 	{
-	    ba.intersections(bxrcv+(*pit), isects);
+	    const std::vector< std::pair<int,Box> >& isects = qisects[iq++];
 
 	    for (int j = 0, M = isects.size(); j < M; ++j)
 	    {
@@ -791,14 +1033,32 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
     const int nlocal = imap.size();
     const int ng = m_ngrow;
     const IndexType& typ = ba.ixType();
-    std::vector< std::pair<int,Box> > isects;
     
     const std::vector<IntVect>& pshifts = m_period.shiftIntVect();
+    const int nshifts = pshifts.size();
     
     CopyComTag::MapOfCopyComTagContainers send_tags; // temp copy
 
     Box pdomain = m_period.Domain();
     pdomain.convert(typ);
+    //
+    // The queries are batched over all boxes and shifts; the loops below
+    // skip exactly the ones that are not queried here.
+    //
+    Array<Box> qbxs;
+    Array< std::vector< std::pair<int,Box> > > qisects;
+
+    for (int i = 0; i < nlocal; ++i) {
+	Box bxsnd = BoxLib::grow(ba[imap[i]],ng);
+	bxsnd &= pdomain;
+	if (!bxsnd.ok()) continue;
+	for (int ip = 0; ip < nshifts; ++ip)
+	    if (pshifts[ip] != IntVect::TheZeroVector())
+		qbxs.push_back(bxsnd+pshifts[ip]);
+    }
+    ba.intersections(qbxs, qisects, ng);
+
+    int iq = 0;
     
     for (int i = 0; i < nlocal; ++i)
     {
@@ -812,7 +1072,7 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
 	{
 	    if (*pit != IntVect::TheZeroVector())
 	    {
-		ba.intersections(bxsnd+(*pit), isects, false, ng);
+		const std::vector< std::pair<int,Box> >& isects = qisects[iq++];
 		
 		for (int j = 0, M = isects.size(); j < M; ++j)
 		{
@@ -848,6 +1108,18 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
 	check_local = true;
     }
 
+    qbxs.clear();
+    for (int i = 0; i < nlocal; ++i) {
+	const Box& bxrcv = BoxLib::grow(ba[imap[i]], ng);
+	if (pdomain.contains(bxrcv)) continue;
+	for (int ip = 0; ip < nshifts; ++ip)
+	    if (pshifts[ip] != IntVect::TheZeroVector())
+		qbxs.push_back(bxrcv+pshifts[ip]);
+    }
+    ba.intersections(qbxs, qisects, ng);
+
+    iq = 0;
+
     for (int i = 0; i < nlocal; ++i)
     {
 	const int   krcv = imap[i];
@@ -870,7 +1142,7 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
 	{
 	    if (*pit != IntVect::TheZeroVector())
 	    {
-		ba.intersections(bxrcv+(*pit), isects, false, ng);
+		const std::vector< std::pair<int,Box> >& isects = qisects[iq++];
 
 		for (int j = 0, M = isects.size(); j < M; ++j)
 		{
@@ -968,6 +1240,9 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
 
 FabArrayBase::FB::~FB ()
 {
+    for (std::map<int,PersistentComm*>::iterator it = m_pcomm.begin(); it != m_pcomm.end(); ++it) {
+	delete it->second;
+    }
     delete m_LocTags;
     delete m_SndTags;
     delete m_RcvTags;
@@ -975,6 +1250,136 @@ FabArrayBase::FB::~FB ()
     delete m_RcvVols;
 }
 
+FabArrayBase::FB::PersistentComm::PersistentComm (const FB& fb, int nbytes, int tag, MPI_Comm comm)
+    : m_nbytes(nbytes), m_tag(tag), m_active(false),
+      m_the_send_data(0), m_the_recv_data(0)
+{
+    BL_PROFILE("FB::PersistentComm::PersistentComm()");
+
+#if defined(BL_USE_MPI) && !defined(BL_USE_UPCXX)
+    const int N_snds = fb.m_SndTags->size();
+    const int N_rcvs = fb.m_RcvTags->size();
+
+    long TotalSndsVolume = 0, TotalRcvsVolume = 0;
+
+    for (std::map<int,int>::const_iterator it = fb.m_SndVols->begin(); it != fb.m_SndVols->end(); ++it)
+	TotalSndsVolume += it->second;
+    for (std::map<int,int>::const_iterator it = fb.m_RcvVols->begin(); it != fb.m_RcvVols->end(); ++it)
+	TotalRcvsVolume += it->second;
+
+    TotalSndsVolume *= nbytes;
+    TotalRcvsVolume *= nbytes;
+
+    if (TotalSndsVolume > 0)
+	m_the_send_data = static_cast<char*>(BoxLib::The_Arena()->alloc(TotalSndsVolume));
+    if (TotalRcvsVolume > 0)
+	m_the_recv_data = static_cast<char*>(BoxLib::The_Arena()->alloc(TotalRcvsVolume));
+
+    m_send_data.reserve(N_snds);
+    m_send_reqs.resize(N_snds, MPI_REQUEST_NULL);
+
+    long Offset = 0;
+    int i = 0;
+    for (MapOfCopyComTagContainers::const_iterator m_it = fb.m_SndTags->begin();
+	 m_it != fb.m_SndTags->end(); ++m_it, ++i)
+    {
+	std::map<int,int>::const_iterator vol_it = fb.m_SndVols->find(m_it->first);
+	BL_ASSERT(vol_it != fb.m_SndVols->end());
+
+	const long N = long(vol_it->second)*nbytes;
+	BL_ASSERT(N < std::numeric_limits<int>::max());
+
+	m_send_data.push_back(m_the_send_data + Offset);
+	BL_MPI_REQUIRE( MPI_Send_init(m_send_data.back(), int(N), MPI_CHAR,
+				      m_it->first, tag, comm, &m_send_reqs[i]) );
+	Offset += N;
+    }
+
+    m_recv_data.reserve(N_rcvs);
+    m_recv_reqs.resize(N_rcvs, MPI_REQUEST_NULL);
+
+    Offset = 0;
+    i = 0;
+    for (MapOfCopyComTagContainers::const_iterator m_it = fb.m_RcvTags->begin();
+	 m_it != fb.m_RcvTags->end(); ++m_it, ++i)
+    {
+	std::map<int,int>::const_iterator vol_it = fb.m_RcvVols->find(m_it->first);
+	BL_ASSERT(vol_it != fb.m_RcvVols->end());
+
+	const long N = long(vol_it->second)*nbytes;
+	BL_ASSERT(N < std::numeric_limits<int>::max());
+
+	m_recv_data.push_back(m_the_recv_data + Offset);
+	BL_MPI_REQUIRE( MPI_Recv_init(m_recv_data.back(), int(N), MPI_CHAR,
+				      m_it->first, tag, comm, &m_recv_reqs[i]) );
+	Offset += N;
+    }
+#endif
+}
+
+FabArrayBase::FB::PersistentComm::~PersistentComm ()
+{
+    BL_ASSERT(!m_active);
+#if defined(BL_USE_MPI) && !defined(BL_USE_UPCXX)
+    for (int i = 0; i < m_send_reqs.size(); ++i) {
+	if (m_send_reqs[i] != MPI_REQUEST_NULL)
+	    MPI_Request_free(&m_send_reqs[i]);
+    }
+    for (int i = 0; i < m_recv_reqs.size(); ++i) {
+	if (m_recv_reqs[i] != MPI_REQUEST_NULL)
+	    MPI_Request_free(&m_recv_reqs[i]);
+    }
+#endif
+    if (m_the_send_data) BoxLib::The_Arena()->free(m_the_send_data);
+    if (m_the_recv_data) BoxLib::The_Arena()->free(m_the_recv_data);
+
+    m_fb_persistent_free_tags.insert(m_tag);
+}
+
+FabArrayBase::FB::PersistentComm*
+FabArrayBase::FB::getPersistentComm (int nbytes) const
+{
+    std::map<int,PersistentComm*>::iterator it = m_pcomm.find(nbytes);
+    if (it != m_pcomm.end())
+	return it->second;
+
+    //
+    // The tags of live PersistentComms must stay unique.  They are bound
+    // and deleted collectively, so all processes pick the same tag.
+    //
+    int tag;
+    if (!m_fb_persistent_free_tags.empty())
+    {
+	tag = *m_fb_persistent_free_tags.begin();
+	m_fb_persistent_free_tags.erase(m_fb_persistent_free_tags.begin());
+    }
+    else
+    {
+	// MPI guarantees at least 32767 tags.
+	if (m_fb_persistent_tag > 32767)
+	    BoxLib::Abort("FB::getPersistentComm: all persistent FillBoundary tags are in use");
+	tag = m_fb_persistent_tag++;
+    }
+
+    PersistentComm* pc = new PersistentComm(*this, nbytes, tag, m_fb_persistent_comm);
+    m_pcomm[nbytes] = pc;
+    return pc;
+}
+
+bool
+FabArrayBase::usePersistentFB (ParallelDescriptor::Color color)
+{
+#if defined(BL_USE_MPI) && !defined(BL_USE_UPCXX)
+    return fb_persistent
+	&& m_fb_persistent_comm != MPI_COMM_NULL
+	&& m_fb_persistent_parent == ParallelDescriptor::Communicator()
+	&& color == ParallelDescriptor::DefaultColor()
+	&& !ParallelDescriptor::MPIOneSided();
+#else
+    return false;
+#endif
+}
+
 void
 FabArrayBase::flushFB (bool no_assertion) const
 {
@@ -982,9 +1387,7 @@ FabArrayBase::flushFB (bool no_assertion) const
     std::pair<FBCacheIter,FBCacheIter> er_it = m_TheFBCache.equal_range(m_bdkey);
     for (FBCacheIter it = er_it.first; it != er_it.second; ++it)
     {
-#ifdef BL_MEM_PROFILING
 	m_FBC_stats.bytes -= it->second->bytes();
-#endif
 	m_FBC_stats.recordErase(it->second->m_nuse);
 	delete it->second;
     }
@@ -1000,9 +1403,7 @@ FabArrayBase::flushFBCache ()
 	delete it->second;
     }
     m_TheFBCache.clear();
-#ifdef BL_MEM_PROFILING
     m_FBC_stats.bytes = 0L;
-#endif
 }
 
 const FabArrayBase::FB&
@@ -1021,6 +1422,7 @@ FabArrayBase::getFB (const Periodicity& period, bool cross, bool enforce_periodi
 	    it->second->m_period == period              )
 	{
 	    ++(it->second->m_nuse);
+	    it->second->m_lastuse = m_FBC_stats.lastuse = ++m_cache_clock;
 	    m_FBC_stats.recordUse();
 	    return *(it->second);
 	}
@@ -1029,17 +1431,17 @@ FabArrayBase::getFB (const Periodicity& period, bool cross, bool enforce_periodi
     // Have to build a new one
     FB* new_fb = new FB(*this, cross, period, enforce_periodicity_only);
 
-#ifdef BL_PROFILE
-    m_FBC_stats.bytes += new_fb->bytes();
-    m_FBC_stats.bytes_hwm = std::max(m_FBC_stats.bytes_hwm, m_FBC_stats.bytes);
-#endif
+    m_FBC_stats.recordBytes(new_fb->bytes());
 
     new_fb->m_nuse = 1;
+    new_fb->m_lastuse = m_FBC_stats.lastuse = ++m_cache_clock;
     m_FBC_stats.recordBuild();
     m_FBC_stats.recordUse();
 
     m_TheFBCache.insert(er_it.second, FBCache::value_type(m_bdkey,new_fb));
 
+    evictCaches();
+
     return *new_fb;
 }
 
@@ -1138,6 +1540,7 @@ FabArrayBase::TheFPinfo (const FabArrayBase& srcfa,
 	    it->second->m_coarsener->doit(it->second->m_dstdomain) == coarsener.doit(dstdomain))
 	{
 	    ++(it->second->m_nuse);
+	    it->second->m_lastuse = m_FPinfo_stats.lastuse = ++m_cache_clock;
 	    m_FPinfo_stats.recordUse();
 	    return *(it->second);
 	}
@@ -1146,12 +1549,10 @@ FabArrayBase::TheFPinfo (const FabArrayBase& srcfa,
     // Have to build a new one
     FPinfo* new_fpc = new FPinfo(srcfa, dstfa, dstdomain, dstng, coarsener);
 
-#ifdef BL_MEM_PROFILING
-    m_FPinfo_stats.bytes += new_fpc->bytes();
-    m_FPinfo_stats.bytes_hwm = std::max(m_FPinfo_stats.bytes_hwm, m_FPinfo_stats.bytes);
-#endif
+    m_FPinfo_stats.recordBytes(new_fpc->bytes());
     
     new_fpc->m_nuse = 1;
+    new_fpc->m_lastuse = m_FPinfo_stats.lastuse = ++m_cache_clock;
     m_FPinfo_stats.recordBuild();
     m_FPinfo_stats.recordUse();
 
@@ -1159,6 +1560,8 @@ FabArrayBase::TheFPinfo (const FabArrayBase& srcfa,
     if (srckey != dstkey)
 	m_TheFillPatchCache.insert(          FPinfoCache::value_type(srckey,new_fpc));
 
+    evictCaches();
+
     return *new_fpc;
 }
 
@@ -1190,9 +1593,7 @@ FabArrayBase::flushFPinfo (bool no_assertion)
 	    }
 	} 
 
-#ifdef BL_MEM_PROFILING
 	m_FPinfo_stats.bytes -= it->second->bytes();
-#endif
 	m_FPinfo_stats.recordErase(it->second->m_nuse);
 	delete it->second;
     }
@@ -1214,6 +1615,14 @@ FabArrayBase::Finalize ()
 
     FabArrayBase::flushTileArrayCache();
 
+#if defined(BL_USE_MPI) && !defined(BL_USE_UPCXX)
+    if (m_fb_persistent_comm != MPI_COMM_NULL) {
+	BL_MPI_REQUIRE( MPI_Comm_free(&m_fb_persistent_comm) );
+	m_fb_persistent_comm   = MPI_COMM_NULL;
+	m_fb_persistent_parent = MPI_COMM_NULL;
+    }
+#endif
+
     if (ParallelDescriptor::IOProcessor() && BoxLib::verbose) {
 	m_FA_stats.print();
 	m_TAC_stats.print();
@@ -1225,32 +1634,194 @@ FabArrayBase::Finalize ()
     initialized = false;
 }
 
+long
+FabArrayBase::cacheBytes ()
+{
+    return m_TAC_stats.bytes + m_FBC_stats.bytes + m_CPC_stats.bytes + m_FPinfo_stats.bytes;
+}
+
+int
+FabArrayBase::CommSeqNum (ParallelDescriptor::Color src_color,
+                          ParallelDescriptor::Color dst_color)
+{
+    if (src_color == ParallelDescriptor::DefaultColor() ||
+        dst_color == ParallelDescriptor::DefaultColor() ||
+        src_color != dst_color)
+    {
+        //
+        // If either FabArray is in the global communicator, or if the two
+        // have different colors, all processes are here.
+        //
+        return ParallelDescriptor::SeqNum();
+    }
+    //
+    // The two have the same non-default color.
+    //
+    if (ParallelDescriptor::SubCommColor() == src_color)
+        return ParallelDescriptor::SubSeqNum();
+
+    return -1;
+}
+
+void
+FabArrayBase::evictCaches ()
+{
+    if (cache_max_bytes < 0 || cacheBytes() <= cache_max_bytes) return;
+
+#ifdef _OPENMP
+    if (omp_in_parallel()) return;
+#endif
+
+    BL_PROFILE("FabArrayBase::evictCaches()");
+    //
+    // Collect everything that may go.  CPCs and FPinfos appear under both
+    // of their keys, so we only take them under the destination key.
+    //
+    std::vector<CacheItem> items;
+
+    if (m_TAC_nactive == 0)
+    {
+	for (TACache::const_iterator tao_it = m_TheTileArrayCache.begin();
+	     tao_it != m_TheTileArrayCache.end(); ++tao_it)
+	{
+	    for (TAMap::const_iterator tai_it = tao_it->second.begin();
+		 tai_it != tao_it->second.end(); ++tai_it)
+	    {
+		if (tai_it->second.lastuse == m_TAC_stats.lastuse) continue;
+		CacheItem item;
+		item.lastuse = tai_it->second.lastuse;
+		item.kind    = CacheItem::TA;
+		item.ptr     = &(tai_it->second);
+		item.bdkey   = tao_it->first;
+		item.takey   = tai_it->first;
+		items.push_back(item);
+	    }
+	}
+    }
+
+    for (FBCacheIter it = m_TheFBCache.begin(); it != m_TheFBCache.end(); ++it)
+    {
+	const FB* fb = it->second;
+	if (fb->m_lastuse == m_FBC_stats.lastuse || fb->hasPersistentComm()) continue;
+	CacheItem item;
+	item.lastuse = fb->m_lastuse;
+	item.kind    = CacheItem::FB;
+	item.ptr     = fb;
+	item.bdkey   = it->first;
+	items.push_back(item);
+    }
+
+    for (CPCacheIter it = m_TheCPCache.begin(); it != m_TheCPCache.end(); ++it)
+    {
+	const CPC* cpc = it->second;
+	if (it->first != cpc->m_dstbdk || cpc->m_lastuse == m_CPC_stats.lastuse) continue;
+	CacheItem item;
+	item.lastuse = cpc->m_lastuse;
+	item.kind    = CacheItem::CPC;
+	item.ptr     = cpc;
+	item.bdkey   = it->first;
+	items.push_back(item);
+    }
+
+    for (FPinfoCacheIter it = m_TheFillPatchCache.begin(); it != m_TheFillPatchCache.end(); ++it)
+    {
+	const FPinfo* fpi = it->second;
+	if (it->first != fpi->m_dstbdk || fpi->m_lastuse == m_FPinfo_stats.lastuse) continue;
+	CacheItem item;
+	item.lastuse = fpi->m_lastuse;
+	item.kind    = CacheItem::FP;
+	item.ptr     = fpi;
+	item.bdkey   = it->first;
+	items.push_back(item);
+    }
+
+    std::sort(items.begin(), items.end());
+
+    for (int i = 0, N = items.size(); i < N && cacheBytes() > cache_max_bytes; ++i)
+    {
+	const CacheItem& item = items[i];
+
+	switch (item.kind)
+	{
+	case CacheItem::TA:
+	{
+	    TACache::iterator tao_it = m_TheTileArrayCache.find(item.bdkey);
+	    TAMap::iterator   tai_it = tao_it->second.find(item.takey);
+	    m_TAC_stats.bytes -= tai_it->second.bytes();
+	    m_TAC_stats.recordErase(tai_it->second.nuse);
+	    ++m_TAC_stats.nevict;
+	    tao_it->second.erase(tai_it);
+	    if (tao_it->second.empty())
+		m_TheTileArrayCache.erase(tao_it);
+	    break;
+	}
+	case CacheItem::FB:
+	{
+	    const FB* fb = static_cast<const FB*>(item.ptr);
+	    EraseCacheEntry(m_TheFBCache, item.bdkey, fb);
+	    m_FBC_stats.bytes -= fb->bytes();
+	    m_FBC_stats.recordErase(fb->m_nuse);
+	    ++m_FBC_stats.nevict;
+	    delete fb;
+	    break;
+	}
+	case CacheItem::CPC:
+	{
+	    const CPC* cpc = static_cast<const CPC*>(item.ptr);
+	    EraseCacheEntry(m_TheCPCache, cpc->m_dstbdk, cpc);
+	    if (cpc->m_srcbdk != cpc->m_dstbdk)
+		EraseCacheEntry(m_TheCPCache, cpc->m_srcbdk, cpc);
+	    m_CPC_stats.bytes -= cpc->bytes();
+	    m_CPC_stats.recordErase(cpc->m_nuse);
+	    ++m_CPC_stats.nevict;
+	    delete cpc;
+	    break;
+	}
+	case CacheItem::FP:
+	{
+	    const FPinfo* fpi = static_cast<const FPinfo*>(item.ptr);
+	    EraseCacheEntry(m_TheFillPatchCache, fpi->m_dstbdk, fpi);
+	    if (fpi->m_srcbdk != fpi->m_dstbdk)
+		EraseCacheEntry(m_TheFillPatchCache, fpi->m_srcbdk, fpi);
+	    m_FPinfo_stats.bytes -= fpi->bytes();
+	    m_FPinfo_stats.recordErase(fpi->m_nuse);
+	    ++m_FPinfo_stats.nevict;
+	    delete fpi;
+	    break;
+	}
+	}
+    }
+}
+
 const FabArrayBase::TileArray* 
-FabArrayBase::getTileArray (const IntVect& tilesize) const
+FabArrayBase::getTileArray (const IntVect& tilesize, int halo) const
 {
     TileArray* p;
 
+    if (halo < 0) halo = -1;
+
 #ifdef _OPENMP
 #pragma omp critical(gettilearray)
 #endif
     {
 	BL_ASSERT(getBDKey() == m_bdkey);
-	p = &FabArrayBase::m_TheTileArrayCache[m_bdkey][tilesize];
+	p = &FabArrayBase::m_TheTileArrayCache[m_bdkey][TAKey(tilesize,halo)];
 	if (p->nuse == -1) {
-	    buildTileArray(tilesize, *p);
+	    if (halo < 0) {
+		buildTileArray(tilesize, *p);
+	    } else {
+		buildTileArray(tilesize, halo, *p);
+	    }
 	    p->nuse = 0;
 	    m_TAC_stats.recordBuild();
-#ifdef BL_MEM_PROFILING
-	    m_TAC_stats.bytes += p->bytes();
-	    m_TAC_stats.bytes_hwm = std::max(m_TAC_stats.bytes_hwm,
-					     m_TAC_stats.bytes);
-#endif
+	    m_TAC_stats.recordBytes(p->bytes());
 	}
 #ifdef _OPENMP
 #pragma omp master
 #endif
 	{
 	    ++(p->nuse);
+	    p->lastuse = m_TAC_stats.lastuse = ++m_cache_clock;
 	    m_TAC_stats.recordUse();
         }
     }
@@ -1304,49 +1875,82 @@ FabArrayBase::buildTileArray (const IntVect& tileSize, TileArray& ta) const
 	    const int i = *it;         // local index 
 	    const int K = indexArray[i]; // global index
 	    const Box& bx = boxarray.getCellCenteredBox(K);
-	    
-	    IntVect nt_in_fab, tsize, nleft;
-	    int ntiles = 1;
-	    for (int d=0; d<BL_SPACEDIM; d++) {
-		int ncells = bx.length(d);
-		nt_in_fab[d] = std::max(ncells/tileSize[d], 1);
-		tsize    [d] = ncells/nt_in_fab[d];
-		nleft    [d] = ncells - nt_in_fab[d]*tsize[d];
-		ntiles *= nt_in_fab[d];
+
+	    const int ntiles = TileBox(bx, tileSize, ta.tileArray);
+
+	    for (int t = 0; t < ntiles; ++t) {
+		ta.indexMap.push_back(K);
+		ta.localIndexMap.push_back(i);
 	    }
-	    
-	    IntVect small, big, ijk;  // note that the initial values are all zero.
-	    ijk[0] = -1;
+	}
+    }
+}
+
+void
+FabArrayBase::buildTileArray (const IntVect& tileSize, int halo, TileArray& ta) const
+{
+    BL_ASSERT(halo >= 0);
+    //
+    // As in the ordinary tiling, but each valid box is first split into its
+    // interior, grow(vbx,-halo), and the boundary shell around it.  All the
+    // interior tiles are stored ahead of the boundary ones.  Nodal BoxArrays
+    // share the faces of their valid boxes with their neighbors, and
+    // FillBoundary may overwrite those, so the interior is one cell smaller
+    // in the nodal directions.
+    //
+    const int N = indexArray.size();
+
+    const IndexType typ = boxarray.ixType();
+
+    IntVect shrink(D_DECL(halo,halo,halo));
+    for (int d=0; d<BL_SPACEDIM; ++d) {
+	if (typ.nodeCentered(d)) ++shrink[d];
+    }
+
+    Array<int> bnd_index, bnd_local_index;
+    Array<Box> bnd_tiles;
+
+    for (int i = 0; i < N; ++i)
+    {
+	if (tileSize == IntVect::TheZeroVector() && !isOwner(i)) continue;
+
+	const int K = indexArray[i];
+	const Box& vbx = boxarray.getCellCenteredBox(K);
+	const Box& ibx = BoxLib::grow(vbx, -shrink);
+
+	if (ibx.ok())
+	{
+	    const int ntiles = TileBox(ibx, tileSize, ta.tileArray);
 	    for (int t = 0; t < ntiles; ++t) {
 		ta.indexMap.push_back(K);
 		ta.localIndexMap.push_back(i);
-		
-		for (int d=0; d<BL_SPACEDIM; d++) {
-		    if (ijk[d]<nt_in_fab[d]-1) {
-			ijk[d]++;
-			break;
-		    } else {
-			ijk[d] = 0;
-		    }
-		}
-		
-		for (int d=0; d<BL_SPACEDIM; d++) {
-		    if (ijk[d] < nleft[d]) {
-			small[d] = ijk[d]*(tsize[d]+1);
-			big[d] = small[d] + tsize[d];
-		    } else {
-			small[d] = ijk[d]*tsize[d] + nleft[d];
-			big[d] = small[d] + tsize[d] - 1;
-		    }
+	    }
+
+	    const BoxList& shell = BoxLib::boxDiff(vbx, ibx);
+	    for (BoxList::const_iterator bli = shell.begin(); bli != shell.end(); ++bli)
+	    {
+		const int nbtiles = TileBox(*bli, tileSize, bnd_tiles);
+		for (int t = 0; t < nbtiles; ++t) {
+		    bnd_index.push_back(K);
+		    bnd_local_index.push_back(i);
 		}
-		
-		Box tbx(small, big, IndexType::TheCellType());
-		tbx.shift(bx.smallEnd());
-		
-		ta.tileArray.push_back(tbx);
+	    }
+	}
+	else
+	{
+	    const int nbtiles = TileBox(vbx, tileSize, bnd_tiles);
+	    for (int t = 0; t < nbtiles; ++t) {
+		bnd_index.push_back(K);
+		bnd_local_index.push_back(i);
 	    }
 	}
     }
+
+    ta.nInterior = ta.tileArray.size();
+
+    ta.indexMap.insert(ta.indexMap.end(), bnd_index.begin(), bnd_index.end());
+    ta.localIndexMap.insert(ta.localIndexMap.end(), bnd_local_index.begin(), bnd_local_index.end());
+    ta.tileArray.insert(ta.tileArray.end(), bnd_tiles.begin(), bnd_tiles.end());
 }
 
 void
@@ -1363,23 +1967,20 @@ FabArrayBase::flushTileArray (const IntVect& tileSize, bool no_assertion) const
 	    for (TAMap::const_iterator tai_it = tao_it->second.begin();
 		 tai_it != tao_it->second.end(); ++tai_it)
 	    {
-#ifdef BL_MEM_PROFILING
 		m_TAC_stats.bytes -= tai_it->second.bytes();
-#endif		
 		m_TAC_stats.recordErase(tai_it->second.nuse);
 	    }
 	    tao.erase(tao_it);
 	} 
 	else 
 	{
+	    // Flush the ordinary and the interior/boundary split tilings.
 	    TAMap& tai = tao_it->second;
-	    TAMap::iterator tai_it = tai.find(tileSize);
-	    if (tai_it != tai.end()) {
-#ifdef BL_MEM_PROFILING
+	    TAMap::iterator tai_it = tai.lower_bound(TAKey(tileSize,-1));
+	    while (tai_it != tai.end() && tai_it->first.first == tileSize) {
 		m_TAC_stats.bytes -= tai_it->second.bytes();
-#endif		
 		m_TAC_stats.recordErase(tai_it->second.nuse);
-		tai.erase(tai_it);
+		tai.erase(tai_it++);
 	    }
 	}
     }
@@ -1398,9 +1999,7 @@ FabArrayBase::flushTileArrayCache ()
 	}
     }
     m_TheTileArrayCache.clear();
-#ifdef BL_MEM_PROFILING
     m_TAC_stats.bytes = 0L;
-#endif
 }
 
 void
@@ -1456,9 +2055,12 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     fabArray(fabarray_),
     tile_size((flags_ & Tiling) ? FabArrayBase::mfiter_tile_size : IntVect::TheZeroVector()),
     flags(flags_),
+    halo(-1),
     index_map(0),
     local_index_map(0),
-    tile_array(0)
+    tile_array(0),
+    m_cost(0),
+    m_cost_t0(0)
 {
     Initialize();
 }
@@ -1469,9 +2071,12 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     fabArray(fabarray_),
     tile_size((do_tiling_) ? FabArrayBase::mfiter_tile_size : IntVect::TheZeroVector()),
     flags(do_tiling_ ? Tiling : 0),
+    halo(-1),
     index_map(0),
     local_index_map(0),
-    tile_array(0)
+    tile_array(0),
+    m_cost(0),
+    m_cost_t0(0)
 {
     Initialize();
 }
@@ -1483,21 +2088,67 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     fabArray(fabarray_),
     tile_size(tilesize_),
     flags(flags_ | Tiling),
+    halo(-1),
+    index_map(0),
+    local_index_map(0),
+    tile_array(0),
+    m_cost(0),
+    m_cost_t0(0)
+{
+    Initialize();
+}
+
+MFIter::MFIter (const FabArrayBase& fabarray_, 
+		unsigned char       flags_,
+		int                 halo_,
+		const IntVect&      tilesize_)
+    :
+    fabArray(fabarray_),
+    tile_size(tilesize_),
+    flags(flags_ | Tiling),
+    halo(halo_ < 0 ? fabarray_.nGrow() : halo_),
     index_map(0),
     local_index_map(0),
-    tile_array(0)
+    tile_array(0),
+    m_cost(0),
+    m_cost_t0(0)
 {
+    BL_ASSERT(((flags & InteriorTiles) != 0) != ((flags & BoundaryTiles) != 0));
     Initialize();
 }
 
 MFIter::~MFIter ()
 {
+    if ( ! (flags & (SkipInit|AllBoxes)) ) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	--FabArrayBase::m_TAC_nactive;
+    }
+
 #if BL_USE_TEAM
     if ( ! (flags & NoTeamBarrier) )
 	ParallelDescriptor::MyTeam().MemoryBarrier();
 #endif
 }
 
+void
+MFIter::measureCost (MeasuredCost& cost)
+{
+    BL_ASSERT(cost.size() == fabArray.size());
+    m_cost    = &cost;
+    m_cost_t0 = ParallelDescriptor::second();
+}
+
+void
+MFIter::recordCost ()
+{
+    const double t = ParallelDescriptor::second();
+    if (isValid())
+        m_cost->add(index(), t - m_cost_t0);
+    m_cost_t0 = t;
+}
+
 void 
 MFIter::Initialize ()
 {
@@ -1513,12 +2164,30 @@ MFIter::Initialize ()
     }
     else
     {
-	const FabArrayBase::TileArray* pta = fabArray.getTileArray(tile_size);
+	const bool split = flags & (InteriorTiles|BoundaryTiles);
+
+	const FabArrayBase::TileArray* pta = split ? fabArray.getTileArray(tile_size, halo)
+	                                           : fabArray.getTileArray(tile_size);
+	//
+	// Keep evictCaches() away from the TileArray we point into.
+	//
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+	++FabArrayBase::m_TAC_nactive;
 	
 	index_map       = &(pta->indexMap);
 	local_index_map = &(pta->localIndexMap);
 	tile_array      = &(pta->tileArray);
 
+	int ibegin = 0;
+	int iend   = index_map->size();
+	if (flags & InteriorTiles) {
+	    iend = pta->nInterior;
+	} else if (flags & BoundaryTiles) {
+	    ibegin = pta->nInterior;
+	}
+
 	{
 	    int rit = 0;
 	    int nworkers = 1;
@@ -1536,22 +2205,22 @@ MFIter::Initialize ()
 	    }
 #endif
 
-	    int ntot = index_map->size();
+	    int ntot = iend - ibegin;
 	    
 	    if (nworkers == 1)
 	    {
-		beginIndex = 0;
-		endIndex = ntot;
+		beginIndex = ibegin;
+		endIndex = iend;
 	    }
 	    else
 	    {
 		int nr   = ntot / nworkers;
 		int nlft = ntot - nr * nworkers;
 		if (rit < nlft) {  // get nr+1 items
-		    beginIndex = rit * (nr + 1);
+		    beginIndex = ibegin + rit * (nr + 1);
 		    endIndex = beginIndex + nr + 1;
 		} else {           // get nr items
-		    beginIndex = rit * nr + nlft;
+		    beginIndex = ibegin + rit * nr + nlft;
 		    endIndex = beginIndex + nr;
 		}
 	    }
@@ -0,0 +1,329 @@
+#include <winstd.H>
+#include <algorithm>
+#include <new>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <BLassert.H>
+#include <PArena.H>
+
+namespace
+{
+    //
+    // Every block starts with a header recording its size class (or -1 for
+    // blocks that are not pooled) and its size.  It takes align_size bytes
+    // so that the memory handed out keeps the alignment of ::operator new().
+    //
+    struct Header
+    {
+        int         sc;
+        std::size_t nbytes;
+    };
+
+    const std::size_t HeaderBytes = 16;
+
+    inline Header* header (void* vp)
+    {
+        return reinterpret_cast<Header*>(static_cast<char*>(vp) - HeaderBytes);
+    }
+}
+
+PArena::PArena ()
+    :
+    m_in_use(0),
+    m_used(0),
+    m_hwm(0)
+{
+    BL_ASSERT(sizeof(Header) <= HeaderBytes && HeaderBytes % Arena::align_size == 0);
+    //
+    // Four size classes per power of two: 64, 80, 96, 112, 128, 160, ...
+    //
+    for (std::size_t base = MinClassBytes; ; base *= 2)
+    {
+        for (int i = 4; i < 8; ++i)
+            m_class_bytes.push_back(base*i/4);
+        if (m_class_bytes.back() >= std::size_t(MaxPooledBytes))
+            break;
+    }
+
+#ifdef _OPENMP
+    const int nthreads = omp_get_max_threads();
+#else
+    const int nthreads = 1;
+#endif
+
+    const int nclasses = m_class_bytes.size();
+
+    m_magazines.resize(nthreads);
+    for (int i = 0; i < nthreads; ++i)
+        m_magazines[i].m_bins.resize(nclasses);
+
+    m_depot.resize(nclasses);
+}
+
+PArena::~PArena ()
+{
+    release();
+}
+
+int
+PArena::sizeClass (std::size_t nbytes) const
+{
+    return std::lower_bound(m_class_bytes.begin(), m_class_bytes.end(), nbytes)
+        - m_class_bytes.begin();
+}
+
+int
+PArena::capacity (int sc) const
+{
+    const long n = MagazineBytes / m_class_bytes[sc];
+    return std::min(256L, std::max(2L, n));
+}
+
+int
+PArena::depotCapacity (int sc) const
+{
+    return std::max(2L, long(DepotBytes / m_class_bytes[sc]));
+}
+
+int
+PArena::threadIndex () const
+{
+#ifdef _OPENMP
+    //
+    // Thread numbers are only unique within the outermost parallel region.
+    //
+    if (omp_get_level() > 1)
+        return -1;
+    const int tid = omp_get_thread_num();
+    return (tid < int(m_magazines.size())) ? tid : -1;
+#else
+    return 0;
+#endif
+}
+
+void*
+PArena::heapAlloc (std::size_t nbytes)
+{
+    void* block = ::operator new(nbytes);
+
+#ifdef _OPENMP
+#pragma omp critical(parena_heap)
+#endif
+    {
+        m_used += nbytes;
+        m_hwm = std::max(m_hwm, m_used);
+    }
+
+    return block;
+}
+
+void
+PArena::heapFree (void* block, std::size_t nbytes)
+{
+    ::operator delete(block);
+
+#ifdef _OPENMP
+#pragma omp critical(parena_heap)
+#endif
+    {
+        m_used -= nbytes;
+    }
+}
+
+void
+PArena::toDepot (std::vector<void*>& bin, int sc, int n)
+{
+    std::vector<void*> surplus;
+
+#ifdef _OPENMP
+#pragma omp critical(parena_depot)
+#endif
+    {
+        std::vector<void*>& depot = m_depot[sc];
+        depot.insert(depot.end(), bin.end()-n, bin.end());
+        const int cap = depotCapacity(sc);
+        if (int(depot.size()) > cap)
+        {
+            surplus.assign(depot.begin()+cap, depot.end());
+            depot.resize(cap);
+        }
+    }
+    bin.resize(bin.size()-n);
+
+    for (int k = 0, K = surplus.size(); k < K; ++k)
+        heapFree(surplus[k], m_class_bytes[sc]);
+}
+
+void
+PArena::fromDepot (std::vector<void*>& bin, int sc, int n)
+{
+#ifdef _OPENMP
+#pragma omp critical(parena_depot)
+#endif
+    {
+        std::vector<void*>& depot = m_depot[sc];
+        n = std::min(n, int(depot.size()));
+        bin.insert(bin.end(), depot.end()-n, depot.end());
+        depot.resize(depot.size()-n);
+    }
+}
+
+void*
+PArena::alloc (std::size_t nbytes)
+{
+    nbytes = Arena::align(nbytes == 0 ? 1 : nbytes) + HeaderBytes;
+
+    void* block = 0;
+    int   sc    = -1;
+
+    if (nbytes > std::size_t(MaxPooledBytes))
+    {
+        block = heapAlloc(nbytes);
+    }
+    else
+    {
+        sc     = sizeClass(nbytes);
+        nbytes = m_class_bytes[sc];
+
+        const int tid = threadIndex();
+
+        if (tid >= 0)
+        {
+            Magazine& mag = m_magazines[tid];
+            std::vector<void*>& bin = mag.m_bins[sc];
+            if (bin.empty())
+                fromDepot(bin, sc, std::max(capacity(sc)/2, 1));
+            if (!bin.empty())
+            {
+                block = bin.back();
+                bin.pop_back();
+            }
+            mag.m_in_use += nbytes;
+        }
+        else
+        {
+#ifdef _OPENMP
+#pragma omp critical(parena_depot)
+#endif
+            {
+                std::vector<void*>& depot = m_depot[sc];
+                if (!depot.empty())
+                {
+                    block = depot.back();
+                    depot.pop_back();
+                }
+                m_in_use += nbytes;
+            }
+        }
+
+        if (block == 0)
+            block = heapAlloc(nbytes);
+    }
+
+    BL_ASSERT(!(block == 0));
+
+    Header* hdr = static_cast<Header*>(block);
+    hdr->sc     = sc;
+    hdr->nbytes = nbytes;
+
+    return static_cast<char*>(block) + HeaderBytes;
+}
+
+void
+PArena::free (void* vp)
+{
+    if (vp == 0)
+        //
+        // Allow calls with NULL as allowed by C++ delete.
+        //
+        return;
+
+    const Header* hdr   = header(vp);
+    const int     sc    = hdr->sc;
+    void*         block = static_cast<char*>(vp) - HeaderBytes;
+
+    if (sc < 0)
+    {
+        heapFree(block, hdr->nbytes);
+        return;
+    }
+
+    BL_ASSERT(sc < int(m_class_bytes.size()) && hdr->nbytes == m_class_bytes[sc]);
+
+    const int tid = threadIndex();
+
+    if (tid >= 0)
+    {
+        Magazine& mag = m_magazines[tid];
+        std::vector<void*>& bin = mag.m_bins[sc];
+        bin.push_back(block);
+        const int cap = capacity(sc);
+        if (int(bin.size()) > cap)
+            toDepot(bin, sc, int(bin.size()) - cap/2);
+        mag.m_in_use -= m_class_bytes[sc];
+    }
+    else
+    {
+        bool pooled;
+
+#ifdef _OPENMP
+#pragma omp critical(parena_depot)
+#endif
+        {
+            pooled = int(m_depot[sc].size()) < depotCapacity(sc);
+            if (pooled)
+                m_depot[sc].push_back(block);
+            m_in_use -= m_class_bytes[sc];
+        }
+
+        if (!pooled)
+            heapFree(block, m_class_bytes[sc]);
+    }
+}
+
+void
+PArena::release ()
+{
+#ifdef _OPENMP
+    BL_ASSERT(!omp_in_parallel());
+#endif
+
+    for (int sc = 0, N = m_class_bytes.size(); sc < N; ++sc)
+    {
+        for (int i = 0, M = m_magazines.size(); i < M; ++i)
+        {
+            std::vector<void*>& bin = m_magazines[i].m_bins[sc];
+            for (int k = 0, K = bin.size(); k < K; ++k)
+                heapFree(bin[k], m_class_bytes[sc]);
+            bin.clear();
+        }
+
+        for (int k = 0, K = m_depot[sc].size(); k < K; ++k)
+            heapFree(m_depot[sc][k], m_class_bytes[sc]);
+        m_depot[sc].clear();
+    }
+}
+
+long
+PArena::heap_space_used () const
+{
+    return m_used;
+}
+
+long
+PArena::heap_space_hwm () const
+{
+    return m_hwm;
+}
+
+long
+PArena::bytes_in_use () const
+{
+    long r = m_in_use;
+    for (int i = 0, N = m_magazines.size(); i < N; ++i)
+        r += m_magazines[i].m_in_use;
+    return r;
+}
@@ -6,6 +6,12 @@
 #include <sstream>
 #include <vector>
 #include <deque>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#ifndef WIN32
+#include <pthread.h>
+#endif
 //
 // This MUST be defined if don't have pubsetbuf() in I/O Streams Library.
 //
@@ -17,9 +23,13 @@
 #include <Utility.H>
 #include <VisMF.H>
 #include <ParmParse.H>
+#include <FabConv.H>
+#include <FPC.H>
 
 static const char* TheMultiFabHdrFileSuffix = "_H";
 
+static const char* TheFabFileSuffix = "_D_";
+
 static const char* TheFabOnDiskPrefix = "FabOnDisk:";
 
 int VisMF::verbose = 1;
@@ -33,6 +43,177 @@ int VisMF::nMFFileInStreams(1);
 namespace
 {
     bool initialized = false;
+    //
+    // The FAB format of Write() set by SetCompression().
+    //
+    bool compress_write = false;
+    Real compress_tol   = 0;
+    //
+    // Switches FAB output to that format while alive.
+    //
+    class FabFormatSwitch
+    {
+    public:
+        FabFormatSwitch ()
+            :
+            m_on(compress_write),
+            m_fmt(FArrayBox::getFormat()),
+            m_tol(FArrayBox::getCompressTol())
+        {
+            if (m_on)
+            {
+                FArrayBox::setFormat(FABio::FAB_COMPRESSED);
+                FArrayBox::setCompressTol(compress_tol);
+            }
+        }
+
+        ~FabFormatSwitch ()
+        {
+            if (m_on)
+            {
+                FArrayBox::setFormat(m_fmt);
+                FArrayBox::setCompressTol(m_tol);
+            }
+        }
+
+    private:
+        bool          m_on;
+        FABio::Format m_fmt;
+        Real          m_tol;
+    };
+    //
+    // ReadInto() reads with at most read_streams processes at a time, each
+    // keeping up to read_ahead on-disk FABs in flight on a reader thread.
+    // Gaps of up to read_gap bytes between the pieces of a FAB it needs
+    // are read through rather than seeked over.
+    //
+    int  read_streams = 64;
+    int  read_ahead   = 4;
+    long read_gap     = 65536;
+    //
+    // Asynchronous writes.  The jobs are done in order by one background
+    // thread, which does no MPI.
+    //
+    bool async_write  = false;
+    long async_max_mb = 1024;
+
+    struct AsyncJob
+    {
+        std::string m_name;
+        long        m_offset;
+        bool        m_trunc;
+        std::string m_data;
+    };
+
+    std::deque<AsyncJob*> async_queue;
+    long                  async_bytes = 0;  // Staged bytes not yet written.
+    bool                  async_busy  = false;
+    bool                  async_stop  = false;
+    std::string           async_error;
+
+    bool
+    WriteAsyncJob (const AsyncJob& job)
+    {
+        std::fstream ofs;
+
+        if (job.m_trunc)
+            ofs.open(job.m_name.c_str(), std::ios::out|std::ios::trunc|std::ios::binary);
+        else
+            ofs.open(job.m_name.c_str(), std::ios::in|std::ios::out|std::ios::binary);
+
+        if (ofs.good())
+        {
+            ofs.seekp(job.m_offset, std::ios::beg);
+            ofs.write(job.m_data.data(), job.m_data.size());
+            ofs.close();
+        }
+
+        return ofs.good();
+    }
+
+    void
+    AsyncJobFailed (const AsyncJob& job)
+    {
+        if (async_error.empty())
+            async_error = "VisMF: asynchronous write of " + job.m_name + " failed";
+    }
+
+#ifndef WIN32
+    pthread_t       async_thread;
+    bool            async_thread_started = false;
+    pthread_mutex_t async_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t  async_cond  = PTHREAD_COND_INITIALIZER;
+
+    extern "C"
+    void*
+    AsyncWriter (void*)
+    {
+        pthread_mutex_lock(&async_mutex);
+
+        for (;;)
+        {
+            while (async_queue.empty() && !async_stop)
+                pthread_cond_wait(&async_cond, &async_mutex);
+
+            if (async_queue.empty()) break;
+
+            AsyncJob* job = async_queue.front();
+            async_queue.pop_front();
+            async_busy = true;
+
+            pthread_mutex_unlock(&async_mutex);
+            const bool ok = WriteAsyncJob(*job);
+            pthread_mutex_lock(&async_mutex);
+
+            if (!ok)
+                AsyncJobFailed(*job);
+            async_bytes -= job->m_data.size();
+            async_busy = false;
+            delete job;
+
+            pthread_cond_broadcast(&async_cond);
+        }
+
+        pthread_mutex_unlock(&async_mutex);
+
+        return 0;
+    }
+#endif
+    //
+    // Queues a job, waiting first if that would take the staged bytes over
+    // vismf.async_max_mb.  Without threads the job is done right away.
+    //
+    void
+    PostAsyncJob (AsyncJob* job)
+    {
+#ifndef WIN32
+        const long n       = job->m_data.size();
+        const long maxbyte = async_max_mb*1024L*1024L;
+
+        pthread_mutex_lock(&async_mutex);
+
+        if (!async_thread_started)
+        {
+            async_stop = false;
+            if (pthread_create(&async_thread, 0, AsyncWriter, 0) != 0)
+                BoxLib::Abort("VisMF: could not start the asynchronous writer");
+            async_thread_started = true;
+        }
+
+        while (async_bytes > 0 && async_bytes + n > maxbyte)
+            pthread_cond_wait(&async_cond, &async_mutex);
+
+        async_queue.push_back(job);
+        async_bytes += n;
+
+        pthread_cond_broadcast(&async_cond);
+        pthread_mutex_unlock(&async_mutex);
+#else
+        if (!WriteAsyncJob(*job))
+            AsyncJobFailed(*job);
+        delete job;
+#endif
+    }
 }
 
 void
@@ -50,6 +231,10 @@ VisMF::Initialize ()
 
     ParmParse pp("vismf");
     pp.query("v",verbose);
+    pp.query("async_max_mb",async_max_mb);
+    pp.query("read_streams",read_streams);
+    pp.query("read_ahead",read_ahead);
+    pp.query("read_gap",read_gap);
 
     initialized = true;
 }
@@ -57,9 +242,75 @@ VisMF::Initialize ()
 void
 VisMF::Finalize ()
 {
+    VisMF::AsyncWait();
+
+#ifndef WIN32
+    if (async_thread_started)
+    {
+        pthread_mutex_lock(&async_mutex);
+        async_stop = true;
+        pthread_cond_broadcast(&async_cond);
+        pthread_mutex_unlock(&async_mutex);
+
+        pthread_join(async_thread, 0);
+
+        async_thread_started = false;
+    }
+#endif
+
+    async_write = false;
+
+    compress_write = false;
+
     initialized = false;
 }
 
+void
+VisMF::SetAsyncWrite (bool async)
+{
+    async_write = async;
+}
+
+bool
+VisMF::GetAsyncWrite ()
+{
+    return async_write;
+}
+
+void
+VisMF::SetCompression (bool compress,
+                       Real tol)
+{
+    BL_ASSERT(tol >= 0);
+    compress_write = compress;
+    compress_tol   = tol;
+}
+
+bool
+VisMF::GetCompression ()
+{
+    return compress_write;
+}
+
+void
+VisMF::AsyncWait ()
+{
+    std::string error;
+
+#ifndef WIN32
+    pthread_mutex_lock(&async_mutex);
+    while (!async_queue.empty() || async_busy)
+        pthread_cond_wait(&async_cond, &async_mutex);
+    std::swap(error, async_error);
+    pthread_mutex_unlock(&async_mutex);
+#else
+    std::swap(error, async_error);
+#endif
+
+    if (!error.empty())
+        BoxLib::Error(error.c_str());
+}
+
 void
 VisMF::SetNOutFiles (int noutfiles)
 {
@@ -267,6 +518,8 @@ operator>> (std::istream&  is,
         hd.m_how = VisMF::OneFilePerCPU; break;
     case VisMF::NFiles:
         hd.m_how = VisMF::NFiles; break;
+    case VisMF::OneFile:
+        hd.m_how = VisMF::OneFile; break;
     default:
         BoxLib::Error("Bad case in switch");
     }
@@ -670,6 +923,81 @@ VisMF::WriteHeader (const std::string& mf_name,
     return bytes;
 }
 
+void
+VisMF::GatherFabOnDisk (const FabArray<FArrayBox>& mf,
+                        const std::string&         mf_name,
+                        VisMF::Header&             hdr)
+{
+#ifdef BL_USE_MPI
+    const int NProcs = ParallelDescriptor::NProcs();
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+
+    Array<int> nmtags(NProcs,0);
+    Array<int> offset(NProcs,0);
+
+    const Array<int>& pmap = mf.DistributionMap().ProcessorMap();
+
+    for (int i = 0, N = mf.size(); i < N; i++)
+        nmtags[pmap[i]]++;
+
+    for (int i = 1, N = offset.size(); i < N; i++)
+        offset[i] = offset[i-1] + nmtags[i-1];
+
+    Array<long> senddata(nmtags[ParallelDescriptor::MyProc()]);
+
+    if (senddata.empty())
+        //
+        // Can't let senddata be empty as senddata.dataPtr() will fail.
+        //
+        senddata.resize(1);
+
+    int ioffset = 0;
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        senddata[ioffset++] = hdr.m_fod[mfi.index()].m_head;
+
+    BL_ASSERT(ioffset == nmtags[ParallelDescriptor::MyProc()]);
+
+    Array<long> recvdata(mf.size());
+
+    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(long),
+                    ParallelDescriptor::MyProc(), BLProfiler::BeforeCall());
+
+    BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
+                                nmtags[ParallelDescriptor::MyProc()],
+                                ParallelDescriptor::Mpi_typemap<long>::type(),
+                                recvdata.dataPtr(),
+                                nmtags.dataPtr(),
+                                offset.dataPtr(),
+                                ParallelDescriptor::Mpi_typemap<long>::type(),
+                                IOProc,
+                                ParallelDescriptor::Communicator()) );
+
+    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(long),
+                    ParallelDescriptor::MyProc(), BLProfiler::AfterCall());
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        Array<int> cnt(NProcs,0);
+
+        for (int j = 0, N = mf.size(); j < N; ++j)
+        {
+            const int i = pmap[j];
+
+            hdr.m_fod[j].m_head = recvdata[offset[i]+cnt[i]];
+
+            const int ifile = (hdr.m_how == VisMF::OneFile) ? 0 : i % nOutFiles;
+
+            std::string name = BoxLib::Concatenate(mf_name + TheFabFileSuffix, ifile, 4);
+
+            hdr.m_fod[j].m_name = VisMF::BaseName(name);
+
+            cnt[i]++;
+        }
+    }
+#endif /*BL_USE_MPI*/
+}
+
 long
 VisMF::Write (const FabArray<FArrayBox>&    mf,
               const std::string& mf_name,
@@ -678,10 +1006,10 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 {
     BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
 
-    static const char* FabFileSuffix = "_D_";
-
     VisMF::Initialize();
 
+    FabFormatSwitch fab_format;
+
     VisMF::Header hdr(mf, how);
 
     if (set_ghost)
@@ -705,12 +1033,20 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
         }
     }
 
+#ifdef BL_USE_MPI
+    if (how == OneFile)
+        return VisMF::WriteOneFile(mf, mf_name, hdr);
+#endif
+
+    if (async_write)
+        return VisMF::AsyncWrite(mf, mf_name, hdr);
+
     long        bytes    = 0;
     const int   MyProc   = ParallelDescriptor::MyProc();
     const int   NProcs   = ParallelDescriptor::NProcs();
     const int   NSets    = (NProcs + (nOutFiles - 1)) / nOutFiles;
     const int   MySet    = MyProc/nOutFiles;
-    std::string FullName = BoxLib::Concatenate(mf_name + FabFileSuffix, MyProc % nOutFiles, 4);
+    std::string FullName = BoxLib::Concatenate(mf_name + TheFabFileSuffix, MyProc % nOutFiles, 4);
 
     const std::string BName = VisMF::BaseName(FullName);
 
@@ -777,97 +1113,340 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 
 #ifdef BL_USE_MPI
     ParallelDescriptor::Barrier("VisMF::Write");
+#endif
 
-    const int IOProc = ParallelDescriptor::IOProcessorNumber();
-
-    Array<int> nmtags(NProcs,0);
-    Array<int> offset(NProcs,0);
-
-    const Array<int>& pmap = mf.DistributionMap().ProcessorMap();
+    VisMF::GatherFabOnDisk(mf, mf_name, hdr);
 
-    for (int i = 0, N = mf.size(); i < N; i++)
-        nmtags[pmap[i]]++;
+    bytes += VisMF::WriteHeader(mf_name, hdr);
 
-    for (int i = 1, N = offset.size(); i < N; i++)
-        offset[i] = offset[i-1] + nmtags[i-1];
+    return bytes;
+}
 
-    Array<long> senddata(nmtags[ParallelDescriptor::MyProc()]);
+long
+VisMF::AsyncWrite (const FabArray<FArrayBox>& mf,
+                   const std::string&         mf_name,
+                   VisMF::Header&             hdr)
+{
+    BL_PROFILE("VisMF::AsyncWrite()");
 
-    if (senddata.empty())
-        //
-        // Can't let senddata be empty as senddata.dataPtr() will fail.
-        //
-        senddata.resize(1);
+    long        bytes    = 0;
+    const int   MyProc   = ParallelDescriptor::MyProc();
+    std::string FullName = BoxLib::Concatenate(mf_name + TheFabFileSuffix, MyProc % nOutFiles, 4);
 
-    int ioffset = 0;
+    const std::string BName = VisMF::BaseName(FullName);
+    //
+    // Snapshot our FABs exactly as Write() would put them in the file.
+    //
+    std::ostringstream FabData(std::ios::out|std::ios::binary);
 
     for (MFIter mfi(mf); mfi.isValid(); ++mfi)
-        senddata[ioffset++] = hdr.m_fod[mfi.index()].m_head;
+    {
+        hdr.m_fod[mfi.index()] = VisMF::Write(mf[mfi],BName,FabData,bytes);
+    }
+    //
+    // The first set creates the files; the others write into them at
+    // the offsets the earlier sets leave, so the files come out the same
+    // as with Write().  The Allgather orders the creation before any
+    // other process can queue its data.
+    //
+    if (MyProc < nOutFiles)
+    {
+        std::ofstream FabFile(FullName.c_str(), std::ios::out|std::ios::trunc|std::ios::binary);
+        if ( ! FabFile.good())
+            BoxLib::FileOpenFailed(FullName);
+    }
 
-    BL_ASSERT(ioffset == nmtags[ParallelDescriptor::MyProc()]);
+    long start = 0;
 
-    Array<long> recvdata(mf.size());
+#ifdef BL_USE_MPI
+    Array<long> allbytes(ParallelDescriptor::NProcs(),0);
+
+    BL_MPI_REQUIRE( MPI_Allgather(&bytes,
+                                  1,
+                                  ParallelDescriptor::Mpi_typemap<long>::type(),
+                                  allbytes.dataPtr(),
+                                  1,
+                                  ParallelDescriptor::Mpi_typemap<long>::type(),
+                                  ParallelDescriptor::Communicator()) );
+
+    for (int iProc = MyProc - nOutFiles; iProc >= 0; iProc -= nOutFiles)
+        start += allbytes[iProc];
+#endif
 
-    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(long),
-                    ParallelDescriptor::MyProc(), BLProfiler::BeforeCall());
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        hdr.m_fod[mfi.index()].m_head += start;
 
-    BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
-                                nmtags[ParallelDescriptor::MyProc()],
-                                ParallelDescriptor::Mpi_typemap<long>::type(),
-                                recvdata.dataPtr(),
-                                nmtags.dataPtr(),
-                                offset.dataPtr(),
-                                ParallelDescriptor::Mpi_typemap<long>::type(),
-                                IOProc,
-                                ParallelDescriptor::Communicator()) );
+    if (bytes > 0)
+    {
+        AsyncJob* job = new AsyncJob;
+        job->m_name   = FullName;
+        job->m_offset = start;
+        job->m_trunc  = false;
+        FabData.str().swap(job->m_data);
+        FabData.str(std::string());
+        PostAsyncJob(job);
+    }
 
-    BL_COMM_PROFILE(BLProfiler::Gatherv, recvdata.size() * sizeof(long),
-                    ParallelDescriptor::MyProc(), BLProfiler::AfterCall());
+    VisMF::GatherFabOnDisk(mf, mf_name, hdr);
 
     if (ParallelDescriptor::IOProcessor())
     {
-        Array<int> cnt(NProcs,0);
-
-        for (int j = 0, N = mf.size(); j < N; ++j)
-        {
-            const int i = pmap[j];
-
-            hdr.m_fod[j].m_head = recvdata[offset[i]+cnt[i]];
+        std::ostringstream MFHdr;
 
-            std::string name = BoxLib::Concatenate(mf_name + FabFileSuffix, i % nOutFiles, 4);
+        MFHdr << hdr;
 
-            hdr.m_fod[j].m_name = VisMF::BaseName(name);
-
-            cnt[i]++;
-        }
+        AsyncJob* job = new AsyncJob;
+        job->m_name   = mf_name + TheMultiFabHdrFileSuffix;
+        job->m_offset = 0;
+        job->m_trunc  = true;
+        job->m_data   = MFHdr.str();
+        bytes += job->m_data.size();
+        PostAsyncJob(job);
     }
-#endif /*BL_USE_MPI*/
-
-    bytes += VisMF::WriteHeader(mf_name, hdr);
 
     return bytes;
 }
 
-VisMF::VisMF (const std::string& mf_name)
-    :
-    m_mfname(mf_name)
+#ifdef BL_USE_MPI
+namespace
 {
-    std::string FullHdrFileName = m_mfname;
-
-    FullHdrFileName += TheMultiFabHdrFileSuffix;
+    //
+    // MPI-IO counts are ints, so OneFileIO() moves at most this many
+    // bytes per call.  Every process makes the same number of calls, as
+    // they are collective.
+    //
+    const long OneFileChunk = 1L << 30;
+
+    void
+    OneFileIO (MPI_File fh,
+               long     offset,
+               char*    data,
+               long     nbytes,
+               bool     write)
+    {
+        int nchunks = (nbytes + OneFileChunk - 1) / OneFileChunk;
 
-    Array<char> fileCharPtr;
-    ParallelDescriptor::ReadAndBcastFile(FullHdrFileName, fileCharPtr);
-    std::string fileCharPtrString(fileCharPtr.dataPtr());
-    std::istringstream ifs(fileCharPtrString, std::istringstream::in);
+        ParallelDescriptor::ReduceIntMax(nchunks);
 
-    ifs >> m_hdr;
+        for (int i = 0; i < nchunks; ++i)
+        {
+            const long lo  = std::min(nbytes, i * OneFileChunk);
+            const int  cnt = std::min(nbytes - lo, OneFileChunk);
 
-    m_pa.resize(m_hdr.m_ncomp);
+            MPI_Status status;
 
-    for (int nComp = 0; nComp < m_pa.size(); ++nComp)
-    {
-        m_pa[nComp].resize(m_hdr.m_ba.size());
+            if (write)
+            {
+                BL_MPI_REQUIRE( MPI_File_write_at_all(fh, offset + lo, data + lo,
+                                                      cnt, MPI_BYTE, &status) );
+            }
+            else
+            {
+                BL_MPI_REQUIRE( MPI_File_read_at_all(fh, offset + lo, data + lo,
+                                                     cnt, MPI_BYTE, &status) );
+            }
+        }
+    }
+}
+
+long
+VisMF::WriteOneFile (const FabArray<FArrayBox>& mf,
+                     const std::string&         mf_name,
+                     VisMF::Header&             hdr)
+{
+    BL_PROFILE("VisMF::WriteOneFile()");
+
+    long              bytes    = 0;
+    const std::string FullName = BoxLib::Concatenate(mf_name + TheFabFileSuffix, 0, 4);
+    const std::string BName    = VisMF::BaseName(FullName);
+    //
+    // Our FABs, laid out as Write() would put them in a file of their own.
+    //
+    std::ostringstream FabData(std::ios::out|std::ios::binary);
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        hdr.m_fod[mfi.index()] = VisMF::Write(mf[mfi],BName,FabData,bytes);
+    }
+    //
+    // They go right after those of the lower ranks.
+    //
+    long start = 0;
+
+    BL_MPI_REQUIRE( MPI_Exscan(&bytes,
+                               &start,
+                               1,
+                               ParallelDescriptor::Mpi_typemap<long>::type(),
+                               MPI_SUM,
+                               ParallelDescriptor::Communicator()) );
+    //
+    // MPI_Exscan() leaves it undefined on the first rank.
+    //
+    if (ParallelDescriptor::MyProc() == 0)
+        start = 0;
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        hdr.m_fod[mfi.index()].m_head += start;
+
+    std::string data;
+    FabData.str().swap(data);
+    FabData.str(std::string());
+
+    MPI_File fh;
+
+    if (MPI_File_open(ParallelDescriptor::Communicator(),
+                      const_cast<char*>(FullName.c_str()),
+                      MPI_MODE_CREATE|MPI_MODE_WRONLY,
+                      MPI_INFO_NULL,
+                      &fh) != MPI_SUCCESS)
+    {
+        BoxLib::FileOpenFailed(FullName);
+    }
+    //
+    // Get rid of whatever a previous, larger write left behind.
+    //
+    BL_MPI_REQUIRE( MPI_File_set_size(fh, 0) );
+
+    OneFileIO(fh, start, data.empty() ? 0 : &data[0], bytes, true);
+
+    BL_MPI_REQUIRE( MPI_File_close(&fh) );
+
+    VisMF::GatherFabOnDisk(mf, mf_name, hdr);
+
+    bytes += VisMF::WriteHeader(mf_name, hdr);
+
+    return bytes;
+}
+
+void
+VisMF::ReadOneFile (FabArray<FArrayBox>& mf,
+                    const std::string&   mf_name,
+                    const VisMF::Header& hdr)
+{
+    BL_PROFILE("VisMF::ReadOneFile()");
+
+    if (hdr.m_fod.empty()) return;
+
+    std::string FullName = VisMF::DirName(mf_name);
+
+    FullName += hdr.m_fod[0].m_name;
+
+    MPI_File fh;
+
+    if (MPI_File_open(ParallelDescriptor::Communicator(),
+                      const_cast<char*>(FullName.c_str()),
+                      MPI_MODE_RDONLY,
+                      MPI_INFO_NULL,
+                      &fh) != MPI_SUCCESS)
+    {
+        BoxLib::FileOpenFailed(FullName);
+    }
+
+    MPI_Offset fsize;
+
+    BL_MPI_REQUIRE( MPI_File_get_size(fh, &fsize) );
+    //
+    // A FAB extends to the start of the next one in the file.
+    //
+    std::vector<long> heads(hdr.m_fod.size());
+
+    for (int i = 0, N = heads.size(); i < N; ++i)
+    {
+        BL_ASSERT(hdr.m_fod[i].m_name == hdr.m_fod[0].m_name);
+
+        heads[i] = hdr.m_fod[i].m_head;
+    }
+
+    std::sort(heads.begin(), heads.end());
+
+    std::vector< std::pair<long,int> > mine;
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        mine.push_back(std::make_pair(hdr.m_fod[mfi.index()].m_head, mfi.index()));
+    //
+    // The file view must visit the file in increasing order.
+    //
+    std::sort(mine.begin(), mine.end());
+
+    const int         N = mine.size();
+    std::vector<int>  blocklens(N);
+    std::vector<long> bufoffs(N+1,0);
+    Array<MPI_Aint>   displs(N);
+
+    for (int i = 0; i < N; ++i)
+    {
+        const long head = mine[i].first;
+
+        std::vector<long>::const_iterator next = std::upper_bound(heads.begin(), heads.end(), head);
+
+        const long tail = (next == heads.end()) ? long(fsize) : *next;
+
+        blocklens[i] = tail - head;
+        displs[i]    = head;
+        bufoffs[i+1] = bufoffs[i] + blocklens[i];
+    }
+
+    MPI_Datatype filetype = MPI_BYTE;
+
+    if (N > 0)
+    {
+        BL_MPI_REQUIRE( MPI_Type_create_hindexed(N,
+                                                 &blocklens[0],
+                                                 displs.dataPtr(),
+                                                 MPI_BYTE,
+                                                 &filetype) );
+        BL_MPI_REQUIRE( MPI_Type_commit(&filetype) );
+    }
+
+    BL_MPI_REQUIRE( MPI_File_set_view(fh,
+                                      0,
+                                      MPI_BYTE,
+                                      filetype,
+                                      const_cast<char*>("native"),
+                                      MPI_INFO_NULL) );
+
+    std::vector<char> buf(bufoffs[N]);
+
+    OneFileIO(fh, 0, buf.empty() ? 0 : &buf[0], bufoffs[N], false);
+
+    BL_MPI_REQUIRE( MPI_File_close(&fh) );
+
+    if (N > 0)
+        BL_MPI_REQUIRE( MPI_Type_free(&filetype) );
+
+    for (int i = 0; i < N; ++i)
+    {
+        std::istringstream is(std::string(&buf[bufoffs[i]], blocklens[i]),
+                              std::ios::in|std::ios::binary);
+
+        mf[mine[i].second].readFrom(is);
+
+        if (is.fail())
+            BoxLib::Error("VisMF::ReadOneFile(): failed to read FAB");
+    }
+}
+#endif /*BL_USE_MPI*/
+
+VisMF::VisMF (const std::string& mf_name)
+    :
+    m_mfname(mf_name)
+{
+    std::string FullHdrFileName = m_mfname;
+
+    FullHdrFileName += TheMultiFabHdrFileSuffix;
+
+    Array<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(FullHdrFileName, fileCharPtr);
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream ifs(fileCharPtrString, std::istringstream::in);
+
+    ifs >> m_hdr;
+
+    m_pa.resize(m_hdr.m_ncomp);
+
+    for (int nComp = 0; nComp < m_pa.size(); ++nComp)
+    {
+        m_pa[nComp].resize(m_hdr.m_ba.size());
 
         for (int ii = 0, N = m_pa[nComp].size(); ii < N; ++ii)
         {
@@ -1009,6 +1588,14 @@ VisMF::Read (FabArray<FArrayBox>&          mf,
     mf.define(hdr.m_ba, hdr.m_ncomp, hdr.m_ngrow, Fab_allocate);
 
 #ifdef BL_USE_MPI
+    if (hdr.m_how == OneFile)
+    {
+        VisMF::ReadOneFile(mf, mf_name, hdr);
+
+        BL_ASSERT(mf.ok());
+
+        return;
+    }
     //
     // Here we limit the number of open files when reading a multifab.
     //
@@ -1216,6 +1803,461 @@ VisMF::Read (FabArray<FArrayBox>&          mf,
 }
 
 
+namespace
+{
+    //
+    // A region of an on-disk FAB needed by one of our FABs.  The extents
+    // are in Reals from the start of the FAB's data, and m_pos gives where
+    // each one starts in m_data.
+    //
+    struct ReadPiece
+    {
+        int               m_dst;
+        Box               m_box;
+        std::vector<long> m_lo;
+        std::vector<long> m_hi;
+        std::vector<long> m_pos;
+        std::vector<char> m_data;
+    };
+    //
+    // All that's needed of one on-disk FAB.  FABs not in a binary format
+    // are left to the main thread to read whole (m_whole).
+    //
+    struct ReadJob
+    {
+        std::string            m_file;
+        long                   m_head;
+        Box                    m_box;
+        RealDescriptor*        m_rd;
+        bool                   m_whole;
+        std::string            m_error;
+        std::vector<ReadPiece> m_pieces;
+    };
+
+    void
+    MakeExtents (ReadPiece&  piece,
+                 const Box&  fabbox,
+                 int         scomp,
+                 int         ncomp,
+                 long        gap)
+    {
+        const Box& bx   = piece.m_box;
+        const long npts = fabbox.numPts();
+
+        for (int n = scomp; n < scomp + ncomp; n++)
+        {
+#if (BL_SPACEDIM == 3)
+            for (int k = bx.smallEnd(2); k <= bx.bigEnd(2); k++)
+#endif
+            {
+                IntVect lo = bx.smallEnd(), hi = bx.bigEnd();
+#if (BL_SPACEDIM == 3)
+                lo[2] = hi[2] = k;
+#endif
+                const long s = n * npts + fabbox.index(lo);
+                const long e = n * npts + fabbox.index(hi) + 1;
+
+                if (!piece.m_hi.empty() && s - piece.m_hi.back() <= gap)
+                {
+                    piece.m_hi.back() = e;
+                }
+                else
+                {
+                    piece.m_lo.push_back(s);
+                    piece.m_hi.push_back(e);
+                }
+            }
+        }
+    }
+    //
+    // Done on the reader thread, so no MPI and no BoxLib::Error().
+    //
+    void
+    RunReadJob (ReadJob& job, std::ifstream& ifs, std::string& open_file)
+    {
+        if (open_file != job.m_file)
+        {
+            ifs.close();
+            ifs.clear();
+            ifs.open(job.m_file.c_str(), std::ios::in|std::ios::binary);
+            open_file = job.m_file;
+        }
+
+        if (!ifs.good())
+        {
+            job.m_error = "VisMF::ReadInto(): couldn't open " + job.m_file;
+            return;
+        }
+
+        ifs.seekg(job.m_head, std::ios::beg);
+
+        char c[4] = { 0, 0, 0, 0 };
+
+        ifs >> c[0] >> c[1] >> c[2] >> c[3];
+
+        if (c[0] != 'F' || c[1] != 'A' || c[2] != 'B')
+        {
+            job.m_error = "VisMF::ReadInto(): no FAB in " + job.m_file;
+            return;
+        }
+
+        if (c[3] == ':')
+        {
+            job.m_whole = true;
+            return;
+        }
+
+        ifs.putback(c[3]);
+
+        Box bx;
+        int nvar;
+
+        job.m_rd = new RealDescriptor;
+
+        ifs >> *job.m_rd >> bx >> nvar;
+        ifs.ignore(100000, '\n');
+
+        if (ifs.fail() || bx != job.m_box)
+        {
+            job.m_error = "VisMF::ReadInto(): bad FAB header in " + job.m_file;
+            return;
+        }
+
+        const long start  = ifs.tellg();
+        const long nbytes = job.m_rd->numBytes();
+
+        for (int i = 0, N = job.m_pieces.size(); i < N; i++)
+        {
+            ReadPiece& piece = job.m_pieces[i];
+
+            long size = 0;
+
+            for (int e = 0, M = piece.m_lo.size(); e < M; e++)
+            {
+                piece.m_pos.push_back(size);
+                size += (piece.m_hi[e] - piece.m_lo[e]) * nbytes;
+            }
+
+            piece.m_data.resize(size);
+
+            for (int e = 0, M = piece.m_lo.size(); e < M; e++)
+            {
+                ifs.seekg(start + piece.m_lo[e] * nbytes, std::ios::beg);
+                ifs.read(&piece.m_data[piece.m_pos[e]], (piece.m_hi[e] - piece.m_lo[e]) * nbytes);
+            }
+
+            if (ifs.fail())
+            {
+                job.m_error = "VisMF::ReadInto(): read of " + job.m_file + " failed";
+                return;
+            }
+        }
+    }
+
+    struct ReadQueue
+    {
+        std::vector<ReadJob>* m_jobs;
+        int                   m_done;
+        int                   m_used;
+#ifndef WIN32
+        pthread_mutex_t       m_mutex;
+        pthread_cond_t        m_cond;
+#endif
+    };
+
+#ifndef WIN32
+    extern "C"
+    void*
+    ReadAhead (void* arg)
+    {
+        ReadQueue&    q = *static_cast<ReadQueue*>(arg);
+        std::ifstream ifs;
+        std::string   open_file;
+
+        for (int i = 0, N = q.m_jobs->size(); i < N; i++)
+        {
+            pthread_mutex_lock(&q.m_mutex);
+            while (q.m_done - q.m_used >= read_ahead)
+                pthread_cond_wait(&q.m_cond, &q.m_mutex);
+            pthread_mutex_unlock(&q.m_mutex);
+
+            RunReadJob((*q.m_jobs)[i], ifs, open_file);
+
+            pthread_mutex_lock(&q.m_mutex);
+            q.m_done++;
+            pthread_cond_broadcast(&q.m_cond);
+            pthread_mutex_unlock(&q.m_mutex);
+        }
+
+        return 0;
+    }
+#endif
+    //
+    // Copies the job's pieces into their FABs.
+    //
+    void
+    FinishReadJob (ReadJob&             job,
+                   FabArray<FArrayBox>& mf,
+                   int                  scomp,
+                   int                  dcomp,
+                   int                  ncomp)
+    {
+        if (!job.m_error.empty())
+            BoxLib::Error(job.m_error.c_str());
+
+        if (job.m_whole)
+        {
+            std::ifstream ifs(job.m_file.c_str(), std::ios::in|std::ios::binary);
+
+            if (!ifs.good())
+                BoxLib::FileOpenFailed(job.m_file);
+
+            ifs.seekg(job.m_head, std::ios::beg);
+
+            FArrayBox fab;
+            fab.readFrom(ifs);
+
+            for (int i = 0, N = job.m_pieces.size(); i < N; i++)
+            {
+                const ReadPiece& piece = job.m_pieces[i];
+
+                mf[piece.m_dst].copy(fab, piece.m_box, scomp, piece.m_box, dcomp, ncomp);
+            }
+            return;
+        }
+
+        const long npts   = job.m_box.numPts();
+        const long nbytes = job.m_rd->numBytes();
+        const bool native = (*job.m_rd == FPC::NativeRealDescriptor());
+
+        for (int i = 0, N = job.m_pieces.size(); i < N; i++)
+        {
+            ReadPiece& piece = job.m_pieces[i];
+            FArrayBox& fab   = mf[piece.m_dst];
+            //
+            // The rows of the region, in the order they are on disk; when
+            // both FABs are just the region a component is one row.
+            //
+            const bool whole = (piece.m_box == job.m_box && fab.box() == job.m_box);
+
+            Box rows(piece.m_box);
+            if (whole)
+                rows = Box(rows.smallEnd(), rows.smallEnd(), rows.ixType());
+            else
+                rows.setBig(0, rows.smallEnd(0));
+
+            const long len = whole ? npts : piece.m_box.length(0);
+            int        e   = 0;
+
+            for (int n = 0; n < ncomp; n++)
+            {
+                for (IntVect iv = rows.smallEnd(); iv <= rows.bigEnd(); rows.next(iv))
+                {
+                    const long elt = (scomp + n) * npts + job.m_box.index(iv);
+
+                    while (elt >= piece.m_hi[e])
+                        e++;
+
+                    BL_ASSERT(elt >= piece.m_lo[e] && elt + len <= piece.m_hi[e]);
+
+                    char* src = &piece.m_data[piece.m_pos[e] + (elt - piece.m_lo[e]) * nbytes];
+
+                    if (native)
+                        std::memcpy(&fab(iv, dcomp + n), src, len * sizeof(Real));
+                    else
+                        RealDescriptor::convertToNativeFormat(&fab(iv, dcomp + n), len, src, *job.m_rd);
+                }
+            }
+
+            std::vector<char>().swap(piece.m_data);
+        }
+    }
+}
+
+void
+VisMF::ReadInto (FabArray<FArrayBox>& mf,
+                 const std::string&   mf_name,
+                 int                  scomp,
+                 int                  dcomp,
+                 int                  ncomp)
+{
+    BL_PROFILE("VisMF::ReadInto()");
+
+    VisMF::Initialize();
+
+    VisMF::Header hdr;
+
+    {
+        Array<char> fileCharPtr;
+        ParallelDescriptor::ReadAndBcastFile(mf_name + TheMultiFabHdrFileSuffix, fileCharPtr);
+        std::string fileCharPtrString(fileCharPtr.dataPtr());
+        std::istringstream ifs(fileCharPtrString, std::istringstream::in);
+
+        ifs >> hdr;
+    }
+
+    if (scomp < 0 || ncomp < 1 || scomp + ncomp > hdr.m_ncomp)
+        BoxLib::Error("VisMF::ReadInto(): the MultiFab on disk has too few components");
+
+    BL_ASSERT(dcomp >= 0 && dcomp + ncomp <= mf.nComp());
+    //
+    // Find the pieces each of our FABs needs.  A FAB that is on disk too
+    // is read with its ghost cells; otherwise we read from the valid
+    // regions of the FABs on disk.
+    //
+    const BoxArray& ba = mf.boxArray();
+
+    std::map<int,int>    jobindex;
+    std::vector<ReadJob> jobs;
+
+    std::vector< std::pair<int,Box> > isects;
+
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const int  idx  = mfi.index();
+        const Box& dbox = mf[mfi].box();
+
+        isects.clear();
+
+        if (idx < hdr.m_ba.size() && hdr.m_ba[idx] == ba[idx])
+        {
+            const Box bx = dbox & BoxLib::grow(hdr.m_ba[idx], hdr.m_ngrow);
+            isects.push_back(std::make_pair(idx, bx));
+        }
+        else
+        {
+            hdr.m_ba.intersections(dbox, isects);
+        }
+
+        for (int i = 0, N = isects.size(); i < N; i++)
+        {
+            const int fab = isects[i].first;
+
+            std::map<int,int>::iterator it = jobindex.find(fab);
+
+            if (it == jobindex.end())
+            {
+                it = jobindex.insert(std::make_pair(fab, int(jobs.size()))).first;
+
+                jobs.push_back(ReadJob());
+                ReadJob& job = jobs.back();
+                job.m_file   = VisMF::DirName(mf_name) + hdr.m_fod[fab].m_name;
+                job.m_head   = hdr.m_fod[fab].m_head;
+                job.m_box    = BoxLib::grow(hdr.m_ba[fab], hdr.m_ngrow);
+                job.m_rd     = 0;
+                job.m_whole  = false;
+            }
+
+            ReadJob& job = jobs[it->second];
+
+            job.m_pieces.push_back(ReadPiece());
+            ReadPiece& piece = job.m_pieces.back();
+            piece.m_dst = idx;
+            piece.m_box = isects[i].second;
+
+            MakeExtents(piece, job.m_box, scomp, ncomp, read_gap / sizeof(Real));
+        }
+    }
+    //
+    // Read the FABs in the order they are on disk.
+    //
+    std::vector< std::pair<std::pair<std::string,long>,int> > order(jobs.size());
+
+    for (int i = 0, N = jobs.size(); i < N; i++)
+        order[i] = std::make_pair(std::make_pair(jobs[i].m_file, jobs[i].m_head), i);
+
+    std::sort(order.begin(), order.end());
+
+    std::vector<ReadJob> sorted(jobs.size());
+
+    for (int i = 0, N = jobs.size(); i < N; i++)
+        std::swap(sorted[i], jobs[order[i].second]);
+
+    jobs.swap(sorted);
+    //
+    // Wait for our turn.
+    //
+    const int MyProc   = ParallelDescriptor::MyProc();
+    const int NProcs   = ParallelDescriptor::NProcs();
+    const int nStreams = std::max(1, std::min(NProcs, read_streams));
+
+    if (MyProc >= nStreams)
+    {
+        int iBuff;
+        ParallelDescriptor::Recv(&iBuff, 1, MyProc - nStreams, MyProc % nStreams);
+    }
+
+    ReadQueue q;
+    q.m_jobs = &jobs;
+    q.m_done = 0;
+    q.m_used = 0;
+
+#ifndef WIN32
+    pthread_t thread;
+    pthread_mutex_init(&q.m_mutex, 0);
+    pthread_cond_init(&q.m_cond, 0);
+
+    const bool threaded = !jobs.empty() && pthread_create(&thread, 0, ReadAhead, &q) == 0;
+#else
+    const bool threaded = false;
+#endif
+
+    for (int i = 0, N = jobs.size(); i < N; i++)
+    {
+        if (threaded)
+        {
+#ifndef WIN32
+            pthread_mutex_lock(&q.m_mutex);
+            while (q.m_done <= i)
+                pthread_cond_wait(&q.m_cond, &q.m_mutex);
+            pthread_mutex_unlock(&q.m_mutex);
+#endif
+        }
+        else
+        {
+            std::ifstream ifs;
+            std::string   open_file;
+            RunReadJob(jobs[i], ifs, open_file);
+        }
+        //
+        // Once the last read is done let the next process in.
+        //
+        if (i == N-1 && MyProc + nStreams < NProcs)
+        {
+            int iBuff = 0;
+            ParallelDescriptor::Send(&iBuff, 1, MyProc + nStreams, MyProc % nStreams);
+        }
+
+        FinishReadJob(jobs[i], mf, scomp, dcomp, ncomp);
+
+        delete jobs[i].m_rd;
+        jobs[i].m_rd = 0;
+
+#ifndef WIN32
+        if (threaded)
+        {
+            pthread_mutex_lock(&q.m_mutex);
+            q.m_used++;
+            pthread_cond_broadcast(&q.m_cond);
+            pthread_mutex_unlock(&q.m_mutex);
+        }
+#endif
+    }
+
+    if (jobs.empty() && MyProc + nStreams < NProcs)
+    {
+        int iBuff = 0;
+        ParallelDescriptor::Send(&iBuff, 1, MyProc + nStreams, MyProc % nStreams);
+    }
+
+#ifndef WIN32
+    if (threaded)
+        pthread_join(thread, 0);
+    pthread_mutex_destroy(&q.m_mutex);
+    pthread_cond_destroy(&q.m_cond);
+#endif
+}
+
 
 void
 VisMF::Check (const std::string& mf_name)
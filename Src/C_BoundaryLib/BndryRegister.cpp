@@ -34,6 +34,8 @@ BndryRegister::BndryRegister (const BoxArray& grids,
 void
 BndryRegister::init (const BndryRegister& src)
 {
+    src.finishPending();
+
     grids = src.grids;
 
     for (int i = 0; i < 2*BL_SPACEDIM; i++)
@@ -57,6 +59,8 @@ BndryRegister::operator= (const BndryRegister& src)
 {
     if (this != &src)
     {
+        finishPending();
+
         if (grids.size() > 0)
         {
             grids.clear();
@@ -148,6 +152,8 @@ BndryRegister::define (Orientation _face,
                        int         _ncomp,
 		       ParallelDescriptor::Color color)
 {
+    finishPending();
+
     BndryBATransformer bbatrans(_face,_typ,_in_rad,_out_rad,_extent_rad);
     BoxArray fsBA(grids, bbatrans);
 
@@ -174,6 +180,8 @@ BndryRegister::define (Orientation                _face,
                        int                        _ncomp,
                        const DistributionMapping& _dm)
 {
+    finishPending();
+
     BndryBATransformer bbatrans(_face,_typ,_in_rad,_out_rad,_extent_rad);
     BoxArray fsBA(grids, bbatrans);
 
@@ -194,6 +202,8 @@ BndryRegister::define (Orientation                _face,
 void
 BndryRegister::setBoxes (const BoxArray& _grids)
 {
+    finishPending();
+
     BL_ASSERT(grids.size() == 0);
     BL_ASSERT(_grids.size() > 0);
     BL_ASSERT(_grids[0].cellCentered());
@@ -208,6 +218,8 @@ BndryRegister::setBoxes (const BoxArray& _grids)
 
 void BndryRegister::setVal (Real v)
 {
+    finishPending();
+
     for (OrientationIter face; face; ++face)
     {
         bndry[face()].setVal(v);
@@ -218,6 +230,8 @@ BndryRegister&
 BndryRegister::operator+= (const BndryRegister& rhs)
 {
     BL_ASSERT(grids == rhs.grids);
+    finishPending();
+    rhs.finishPending();
     for (OrientationIter face; face; ++face) {
 #ifdef _OPENMP
 #pragma omp parallel
@@ -246,6 +260,8 @@ BndryRegister::linComb (Real            a,
                         int             num_comp,
                         int             n_ghost)
 {
+    finishPending();
+
     for (OrientationIter face; face; ++face)
     {
         bndry[face()].linComb(a,
@@ -268,6 +284,8 @@ BndryRegister::copyFrom (const MultiFab& src,
                          int             dest_comp,
                          int             num_comp)
 {
+    finishPending();
+
     for (OrientationIter face; face; ++face)
     {
         bndry[face()].copyFrom(src,nghost,src_comp,dest_comp,num_comp);
@@ -282,6 +300,8 @@ BndryRegister::plusFrom (const MultiFab& src,
                          int             dest_comp,
                          int             num_comp)
 {
+    finishPending();
+
     for (OrientationIter face; face; ++face)
     {
         bndry[face()].plusFrom(src,nghost,src_comp,dest_comp,num_comp);
@@ -292,6 +312,8 @@ BndryRegister::plusFrom (const MultiFab& src,
 void
 BndryRegister::write (const std::string& name, std::ostream& os) const
 {
+    finishPending();
+
     if (ParallelDescriptor::IOProcessor(color()))
     {
         grids.writeOn(os);
@@ -317,6 +339,8 @@ BndryRegister::write (const std::string& name, std::ostream& os) const
 void
 BndryRegister::read (const std::string& name, std::istream& is)
 {
+    finishPending();
+
     grids.readFrom(is);
 
     for (OrientationIter face; face; ++face)
@@ -339,6 +363,9 @@ BndryRegister::read (const std::string& name, std::istream& is)
 void 
 BndryRegister::Copy (BndryRegister& dst, const BndryRegister& src)
 {
+    dst.finishPending();
+    src.finishPending();
+
     for (OrientationIter face; face; ++face)
     {
 	FabSet::Copy(dst[face()], src[face()]);
@@ -349,6 +376,8 @@ void
 BndryRegister::AddProcsToComp(int ioProcNumSCS, int ioProcNumAll,
                               int scsMyId, MPI_Comm scsComm)
 {
+  finishPending();
+
   // ---- BoxArrays
   BoxLib::BroadcastBoxArray(grids, scsMyId, ioProcNumSCS, scsComm);
 
@@ -94,6 +94,28 @@ FabSet::plusTo (MultiFab& dest, int ngrow, int scomp, int dcomp, int ncomp,
     dest.copy(m_mf,scomp,dcomp,ncomp,0,ngrow,period,FabArrayBase::ADD);
 }
 
+void
+FabSet::copyFrom_nowait (const MultiFab& src, int ngrow, int scomp, int dcomp, int ncomp,
+			 FabArrayBase::CpOp op)
+{
+    BL_ASSERT(boxArray() != src.boxArray());
+    m_mf.copy_nowait(src,scomp,dcomp,ncomp,ngrow,0,Periodicity::NonPeriodic(),op);
+}
+
+void
+FabSet::copyFrom_finish ()
+{
+    m_mf.copy_finish();
+}
+
+void
+FabSet::copyTo_nowait (MultiFab& dest, int ngrow, int scomp, int dcomp, int ncomp,
+		       const Periodicity& period) const
+{
+    BL_ASSERT(boxArray() != dest.boxArray());
+    dest.copy_nowait(m_mf,scomp,dcomp,ncomp,0,ngrow,period);
+}
+
 void
 FabSet::setVal (Real val)
 {
@@ -892,3 +892,138 @@ operator<< (std::ostream& os, const ParticleBase& p)
     return os;
 }
 
+
+int
+ParticleBase::SortInterval ()
+{
+    static int Sort_Interval;
+
+    static bool first = true;
+
+    if (first)
+    {
+        first = false;
+
+        ParmParse pp("particles");
+
+        Sort_Interval = 0;
+
+        pp.query("sort_interval", Sort_Interval);
+    }
+
+    return Sort_Interval;
+}
+
+ParticleTiling::ParticleTiling (const Box&     bx,
+                                const IntVect& tile_size)
+    :
+    m_box(bx)
+{
+    BL_ASSERT(bx.ok());
+
+    for (int d = 0; d < BL_SPACEDIM; d++)
+    {
+        const int len = bx.length(d);
+        //
+        // At least two cells wide, so tiles two apart don't touch when grown by one.
+        //
+        const int nt = std::max(1, std::min((len + tile_size[d] - 1) / tile_size[d], len / 2));
+
+        m_ntiles[d] = nt;
+
+        m_which[d].resize(len);
+
+        for (int k = 0; k < nt; k++)
+        {
+            const int lo = (long(len) *  k   ) / nt;
+            const int hi = (long(len) * (k+1)) / nt;
+
+            for (int i = lo; i < hi; i++)
+                m_which[d][i] = k;
+        }
+    }
+
+    const int ntiles = D_TERM(m_ntiles[0],*m_ntiles[1],*m_ntiles[2]);
+
+    m_tiles.resize(ntiles);
+    m_offset.resize(ntiles+1);
+    m_colors.resize(1 << BL_SPACEDIM);
+
+    m_offset[0] = 0;
+
+    for (int t = 0; t < ntiles; t++)
+    {
+        IntVect tiv, lo, hi;
+
+        int color = 0;
+
+        for (int d = 0, r = t; d < BL_SPACEDIM; d++)
+        {
+            const int nt  = m_ntiles[d];
+            const int len = bx.length(d);
+
+            tiv[d] = r % nt;
+            r     /= nt;
+
+            lo[d]  = bx.smallEnd(d) + (long(len) *  tiv[d]   ) / nt;
+            hi[d]  = bx.smallEnd(d) + (long(len) * (tiv[d]+1)) / nt - 1;
+
+            color |= (tiv[d] & 1) << d;
+        }
+
+        m_tiles[t]    = Box(lo, hi, bx.ixType());
+        m_offset[t+1] = m_offset[t] + m_tiles[t].numPts();
+
+        m_colors[color].push_back(t);
+    }
+}
+
+IntVect
+ParticleTiling::clamp (const IntVect& iv) const
+{
+    return BoxLib::min(BoxLib::max(iv, m_box.smallEnd()), m_box.bigEnd());
+}
+
+int
+ParticleTiling::tileIndex (const IntVect& iv) const
+{
+    const IntVect civ = clamp(iv);
+
+    int t = 0;
+
+    for (int d = BL_SPACEDIM-1; d >= 0; d--)
+        t = t * m_ntiles[d] + m_which[d][civ[d] - m_box.smallEnd(d)];
+
+    return t;
+}
+
+long
+ParticleTiling::cellIndex (const IntVect& iv) const
+{
+    const IntVect civ = clamp(iv);
+
+    const int t = tileIndex(civ);
+
+    return m_offset[t] + m_tiles[t].index(civ);
+}
+
+int
+ParticleBase::NeighborCells ()
+{
+    static int Neighbor_Cells;
+
+    static bool first = true;
+
+    if (first)
+    {
+        first = false;
+
+        ParmParse pp("particles");
+
+        Neighbor_Cells = 2;
+
+        pp.query("neighbor_cells", Neighbor_Cells);
+    }
+
+    return Neighbor_Cells;
+}
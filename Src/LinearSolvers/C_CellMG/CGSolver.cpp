@@ -240,6 +240,116 @@ dotxy (const MultiFab& r,
     return MultiFab::Dot(r,0,z,0,ncomp,nghost,local);
 }
 
+namespace
+{
+    //
+    // d[0] = s[0] + a1*s[1] and d[1] = s[2] + a2*s[3], with the max norms
+    // of d[0] and d[1] in r[0] and r[1].
+    //
+    struct SxaySxayNorm
+    {
+	SxaySxayNorm (Real a1_, Real a2_) : a1(a1_), a2(a2_) {}
+	void operator() (int n, Real* const* d, const Real* const* s, Real* r) const
+	{
+	    Real*       s1 = d[0];
+	    Real*       s2 = d[1];
+	    const Real* x1 = s[0];
+	    const Real* y1 = s[1];
+	    const Real* x2 = s[2];
+	    const Real* y2 = s[3];
+	    Real nm1 = r[0], nm2 = r[1];
+	    for (int i = 0; i < n; ++i)
+	    {
+		s1[i] = x1[i] + a1*y1[i];
+		s2[i] = x2[i] + a2*y2[i];
+		nm1 = std::max(nm1, std::abs(s1[i]));
+		nm2 = std::max(nm2, std::abs(s2[i]));
+	    }
+	    r[0] = nm1;
+	    r[1] = nm2;
+	}
+	Real a1, a2;
+    };
+    //
+    // r[0] += s[0]*s[0] and r[1] += s[0]*s[1].
+    //
+    struct DotxxDotxy
+    {
+	void operator() (int n, Real* const*, const Real* const* s, Real* r) const
+	{
+	    const Real* x = s[0];
+	    const Real* y = s[1];
+	    Real xx = r[0], xy = r[1];
+	    for (int i = 0; i < n; ++i)
+	    {
+		xx += x[i]*x[i];
+		xy += x[i]*y[i];
+	    }
+	    r[0] = xx;
+	    r[1] = xy;
+	}
+    };
+}
+
+//
+// ss1 = xx1 + a1*yy1 and ss2 = xx2 + a2*yy2 in one sweep, which also
+// returns norm_inf(ss1) and norm_inf(ss2).
+//
+static
+void
+sxay_sxay_norm (MultiFab&       ss1,
+		const MultiFab& xx1,
+		Real            a1,
+		const MultiFab& yy1,
+		MultiFab&       ss2,
+		const MultiFab& xx2,
+		Real            a2,
+		const MultiFab& yy2,
+		Real&           ss1_norm,
+		Real&           ss2_norm,
+		bool            local = false)
+{
+    BL_PROFILE("CGSolver::sxay_sxay_norm()");
+
+    Array<MultiFab*> dst(2);
+    dst[0] = &ss1;
+    dst[1] = &ss2;
+
+    Array<const MultiFab*> src(4);
+    src[0] = &xx1;
+    src[1] = &yy1;
+    src[2] = &xx2;
+    src[3] = &yy2;
+
+    Array<Real> nrm(2);
+    MultiFab::ElementWiseReduce(dst, src, 0, 1, 0, SxaySxayNorm(a1,a2),
+				nrm, MultiFab::ReduceMax, local);
+    ss1_norm = nrm[0];
+    ss2_norm = nrm[1];
+}
+
+//
+// The local dot products (x,x) and (x,y) in one sweep.
+//
+static
+void
+dotxx_dotxy (const MultiFab& x,
+	     const MultiFab& y,
+	     Real*           vals)
+{
+    BL_PROFILE("CGSolver::dotxx_dotxy()");
+
+    Array<const MultiFab*> src(2);
+    src[0] = &x;
+    src[1] = &y;
+
+    Array<Real> dots(2);
+    MultiFab::ElementWiseReduce(Array<MultiFab*>(), src, 0, 1, 0, DotxxDotxy(),
+				dots, MultiFab::ReduceSum, true);
+    vals[0] = dots[0];
+    vals[1] = dots[1];
+}
+
 //
 // z[m] = A[m][n]*x[n]   [row][col]
 //
@@ -941,10 +1051,7 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 	{
             ret = 2; break;
 	}
-        sxay(sol, sol,  alpha, ph);
-        sxay(s,     r, -alpha,  v);
-
-        rnorm = norm_inf(s);
+        sxay_sxay_norm(sol, sol, alpha, ph, s, r, -alpha, v, sol_norm, rnorm);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
         {
@@ -958,7 +1065,6 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 #ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
         if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
 #else
-        sol_norm = norm_inf(sol);
         if ( rnorm < eps_rel*(Lp_norm*sol_norm + rnorm0 ) || rnorm < eps_abs ) break;
 #endif
         if ( use_mg_precond )
@@ -981,7 +1087,8 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
         // in the following two dotxy()s.  We do that by calculating the "local"
         // values and then reducing the two local values at the same time.
         //
-        Real vals[2] = { dotxy(t,t,true), dotxy(t,s,true) };
+        Real vals[2];
+        dotxx_dotxy(t, s, vals);
 
         ParallelDescriptor::ReduceRealSum(vals,2,color());
 
@@ -993,10 +1100,7 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 	{
             ret = 3; break;
 	}
-        sxay(sol, sol,  omega, sh);
-        sxay(r,     s, -omega,  t);
-
-        rnorm = norm_inf(r);
+        sxay_sxay_norm(sol, sol, omega, sh, r, s, -omega, t, sol_norm, rnorm);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
         {
@@ -1010,7 +1114,6 @@ CGSolver::solve_bicgstab (MultiFab&       sol,
 #ifdef CG_USE_OLD_CONVERGENCE_CRITERIA
         if ( rnorm < eps_rel*rnorm0 || rnorm < eps_abs ) break;
 #else
-        sol_norm = norm_inf(sol);
         if ( rnorm < eps_rel*(Lp_norm*sol_norm + rnorm0 ) || rnorm < eps_abs ) break;
 #endif
         if ( omega == 0 )
@@ -1163,10 +1266,7 @@ CGSolver::solve_cg (MultiFab&       sol,
                       << " rho " << rho
                       << " alpha " << alpha << '\n';
         }
-        sxay(sol, sol, alpha, p);
-        sxay(  r,   r,-alpha, q);
-        rnorm = norm_inf(r);
-        sol_norm = norm_inf(sol);
+        sxay_sxay_norm(sol, sol, alpha, p, r, r, -alpha, q, sol_norm, rnorm);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
         {
@@ -1325,10 +1425,7 @@ CGSolver::jbb_precond (MultiFab&       sol,
             std::cout << "jbb_precond:" << " nit " << nit
                       << " rho " << rho << " alpha " << alpha << '\n';
         }
-        sxay(sol, sol, alpha, p);
-        sxay(  r,   r,-alpha, q);
-        rnorm    = norm_inf(r,   local);
-        sol_norm = norm_inf(sol, local);
+        sxay_sxay_norm(sol, sol, alpha, p, r, r, -alpha, q, sol_norm, rnorm, local);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor(color()) )
         {
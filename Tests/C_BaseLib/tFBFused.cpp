@@ -0,0 +1,122 @@
+//
+// Compares FabArray::FillBoundaryFused() with a FillBoundary() on each
+// MultiFab, for MultiFabs of one index type and for a mix of cell-centered
+// and nodal MultiFabs on the same grids.
+//
+//   tFBFused.ex [n_cell=64] [max_grid_size=16] [nghost=2]
+//
+#include <iostream>
+
+#include <BoxLib.H>
+#include <MultiFab.H>
+#include <ParmParse.H>
+#include <ParallelDescriptor.H>
+
+namespace
+{
+    //
+    // Valid cells get a value unique to their index and component; ghost
+    // cells get one FillBoundary() has to overwrite.
+    //
+    void
+    fill (MultiFab& mf)
+    {
+        mf.setVal(-1.0e30);
+
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            const Box& bx  = mfi.validbox();
+            FArrayBox& fab = mf[mfi];
+
+            for (int n = 0; n < mf.nComp(); ++n)
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+                    fab(iv,n) = D_TERM(iv[0], + 1000.0*iv[1], + 1.0e6*iv[2]) + 1.0e9*n;
+        }
+    }
+
+    Real
+    fused_vs_separate (const Array<MultiFab*>& mfs, const Periodicity& period)
+    {
+        const int N = mfs.size();
+
+        PArray<MultiFab> ref(N, PArrayManage);
+        Array<FabArray<FArrayBox>*> fas(N);
+        Array<int> scomp(N, 0), ncomp(N);
+
+        for (int k = 0; k < N; ++k)
+        {
+            MultiFab& mf = *mfs[k];
+
+            fill(mf);
+
+            ref.set(k, new MultiFab(mf.boxArray(), mf.nComp(), mf.nGrow()));
+            MultiFab::Copy(ref[k], mf, 0, 0, mf.nComp(), mf.nGrow());
+            ref[k].FillBoundary(period);
+
+            fas[k]   = &mf;
+            ncomp[k] = mf.nComp();
+        }
+
+        FabArray<FArrayBox>::FillBoundaryFused(fas, scomp, ncomp, period);
+
+        Real diff = 0;
+
+        for (int k = 0; k < N; ++k)
+        {
+            MultiFab::Subtract(ref[k], *mfs[k], 0, 0, ref[k].nComp(), ref[k].nGrow());
+
+            for (int n = 0; n < ref[k].nComp(); ++n)
+                diff = std::max(diff, ref[k].norm0(n, ref[k].nGrow()));
+        }
+
+        return diff;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell = 64, max_grid_size = 16, nghost = 2;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nghost", nghost);
+    }
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+
+    const Periodicity period(IntVect(D_DECL(n_cell,n_cell,n_cell)));
+
+    MultiFab cc1(ba, 2, nghost), cc2(ba, 1, nghost);
+    MultiFab nd(BoxArray(ba).surroundingNodes(), 1, nghost);
+
+    Array<MultiFab*> same_type(2);
+    same_type[0] = &cc1;
+    same_type[1] = &cc2;
+
+    Array<MultiFab*> mixed_type(3);
+    mixed_type[0] = &cc1;
+    mixed_type[1] = &nd;
+    mixed_type[2] = &cc2;
+
+    const Real diff_same  = fused_vs_separate(same_type,  period);
+    const Real diff_mixed = fused_vs_separate(mixed_type, period);
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << ba.size() << " grids on " << ParallelDescriptor::NProcs() << " procs\n"
+                  << "cell-centered:       max difference " << diff_same  << '\n'
+                  << "cell-centered+nodal: max difference " << diff_mixed << '\n';
+
+    if (diff_same != 0 || diff_mixed != 0)
+        BoxLib::Abort("tFBFused: FillBoundaryFused and FillBoundary disagree");
+
+    BoxLib::Finalize();
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+//
+// Compares the C++ and Fortran versions of the BaseFab<Real> kernels:
+// checks that they agree and times them on tiles of a FAB with ghost cells.
+//
+//   tFabKernels.ex [n_cell=64] [tile_size=t] [ncomp=1] [nrep=20]
+//
+// The tiles are those of MFIter unless tile_size is given.
+//
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include <BoxLib.H>
+#include <FArrayBox.H>
+#include <FabArray.H>
+#include <ParmParse.H>
+#include <ParallelDescriptor.H>
+
+namespace
+{
+    void
+    fill (FArrayBox& fab, Real x0)
+    {
+        Real* p = fab.dataPtr();
+        const long n = fab.box().numPts() * fab.nComp();
+        for (long i = 0; i < n; ++i)
+            p[i] = x0 + std::sin(Real(i));
+    }
+
+    Real
+    maxdiff (const FArrayBox& a, const FArrayBox& b)
+    {
+        FArrayBox c(a.box(), a.nComp());
+        c.copy(a);
+        c.minus(b);
+        return c.norm(0, 0, a.nComp());
+    }
+
+    enum Op { SetVal, Copy, Plus, Mult, Saxpy, Sum, Norm0, Norm1, Dot, NOps };
+
+    const char* op_name[NOps] = { "setVal", "copy", "plus", "mult", "saxpy",
+                                  "sum", "norm0", "norm1", "dot" };
+
+    Real
+    run (Op op, FArrayBox& dst, const FArrayBox& src, const BoxList& tiles, int ncomp)
+    {
+        Real r = 0;
+
+        for (BoxList::const_iterator it = tiles.begin(); it != tiles.end(); ++it)
+        {
+            const Box& bx = *it;
+
+            switch (op)
+            {
+            case SetVal: dst.setVal(1.5, bx, 0, ncomp);                  break;
+            case Copy:   dst.copy(src, bx, 0, bx, 0, ncomp);             break;
+            case Plus:   dst.plus(src, bx, bx, 0, 0, ncomp);             break;
+            case Mult:   dst.mult(src, bx, bx, 0, 0, ncomp);             break;
+            case Saxpy:  dst.saxpy(0.5, src, bx, bx, 0, 0, ncomp);       break;
+            case Sum:    r += src.sum(bx, 0, ncomp);                     break;
+            case Norm0:  r = std::max(r, src.norm(bx, 0, 0, ncomp));     break;
+            case Norm1:  r += src.norm(bx, 1, 0, ncomp);                 break;
+            case Dot:    r += dst.dot(bx, 0, src, bx, 0, ncomp);         break;
+            default:                                                     break;
+            }
+        }
+
+        return r;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    BoxLib::Initialize(argc,argv);
+
+    int n_cell = 64, ncomp = 1, nrep = 20;
+    IntVect tile_size = FabArrayBase::mfiter_tile_size;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        int ts;
+        if (pp.query("tile_size", ts))
+            tile_size = IntVect(D_DECL(ts,ts,ts));
+        pp.query("ncomp", ncomp);
+        pp.query("nrep", nrep);
+    }
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    const Box grown = BoxLib::grow(domain, 2);
+
+    BoxList tiles(domain);
+    tiles.maxSize(tile_size);
+
+    FArrayBox src(grown, ncomp), dst(grown, ncomp), dst_f(grown, ncomp);
+    fill(src, 1.0);
+
+    const bool cxx_kernels = BoxLib::FabCxxKernels();
+    bool ok = true;
+
+    if (ParallelDescriptor::IOProcessor())
+        std::cout << "n_cell = " << n_cell << ", tile_size = " << tile_size
+                  << ", ncomp = " << ncomp << ", " << tiles.size() << " tiles\n"
+                  << std::setw(8) << "op" << std::setw(14) << "C++ (s)"
+                  << std::setw(14) << "Fortran (s)" << std::setw(10) << "ratio"
+                  << std::setw(14) << "difference" << '\n';
+
+    for (int iop = 0; iop < NOps; ++iop)
+    {
+        const Op op = static_cast<Op>(iop);
+        Real res[2], tm[2];
+
+        for (int ik = 0; ik < 2; ++ik)
+        {
+            FArrayBox& d = (ik == 0) ? dst : dst_f;
+            BoxLib::SetFabCxxKernels(ik == 0);
+
+            fill(d, 2.0);
+            res[ik] = run(op, d, src, tiles, ncomp);
+
+            const Real t0 = ParallelDescriptor::second();
+            for (int irep = 0; irep < nrep; ++irep)
+                run(op, d, src, tiles, ncomp);
+            tm[ik] = ParallelDescriptor::second() - t0;
+        }
+
+        Real diff = std::abs(res[0] - res[1]) / std::max(Real(1), std::abs(res[1]));
+        diff = std::max(diff, maxdiff(dst, dst_f));
+
+        if (diff > 1.e-10)
+            ok = false;
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << std::setw(8) << op_name[iop]
+                      << std::setw(14) << tm[0] << std::setw(14) << tm[1]
+                      << std::setw(10) << std::setprecision(3) << tm[1]/tm[0]
+                      << std::setw(14) << diff << std::setprecision(6) << '\n';
+    }
+
+    BoxLib::SetFabCxxKernels(cxx_kernels);
+
+    if (!ok)
+        BoxLib::Abort("tFabKernels: C++ and Fortran kernels disagree");
+
+    BoxLib::Finalize();
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <BoxLib.H>
+#include <PArena.H>
+
+//
+// Allocates blocks of random sizes from all threads, checks their
+// contents and frees them from a different thread than the allocating one.
+//
+int
+main ()
+{
+    PArena arena;
+
+    const int NBlocks = 4000;
+
+    std::vector<double*> blocks(NBlocks);
+    std::vector<long>    sizes(NBlocks);
+
+    for (int j = 0; j < 10; j++)
+    {
+        std::cout << "Loop == " << j << std::endl;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < NBlocks; i++)
+        {
+            unsigned long r = 1103515245UL*(i+1)*(j+1) + 12345UL;
+            long n = (r/7) % (i%10 == 0 ? 300000 : 2000);
+            sizes[i]  = n;
+            blocks[i] = static_cast<double*>(arena.alloc(n*sizeof(double)));
+            for (long k = 0; k < n; k++)
+                blocks[i][k] = i+k;
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,7)
+#endif
+        for (int i = NBlocks-1; i >= 0; i--)
+        {
+            for (long k = 0; k < sizes[i]; k++)
+                if (blocks[i][k] != i+k)
+                    BoxLib::Abort("tPArena: block was corrupted");
+            arena.free(blocks[i]);
+        }
+
+        if (arena.bytes_in_use() != 0)
+            BoxLib::Abort("tPArena: bytes_in_use() != 0");
+
+        std::cout << "heap space used: " << arena.heap_space_used()
+                  << ", hwm: " << arena.heap_space_hwm() << std::endl;
+    }
+
+    arena.release();
+
+    if (arena.heap_space_used() != 0)
+        BoxLib::Abort("tPArena: heap_space_used() != 0 after release()");
+
+    return 0;
+}
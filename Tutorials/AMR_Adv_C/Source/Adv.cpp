@@ -58,6 +58,20 @@ Adv::Adv (Amr&            papa,
         flux_reg = new FluxRegister(grids,crse_ratio,level,NUM_STATE);
 }
 
+Adv::Adv (Amr&                       papa,
+	  int                        lev,
+	  const Geometry&            level_geom,
+	  const BoxArray&            bl,
+	  const DistributionMapping& dm,
+	  Real                       time)
+    :
+    AmrLevel(papa,lev,level_geom,bl,dm,time) 
+{
+    flux_reg = 0;
+    if (level > 0 && do_reflux)
+        flux_reg = new FluxRegister(grids,crse_ratio,level,NUM_STATE);
+}
+
 Adv::~Adv () 
 {
     delete flux_reg;
@@ -105,9 +119,7 @@ Adv::init (AmrLevel &old)
     Real dt_old    = cur_time - prev_time;
     setTimeLevel(cur_time,dt_old,dt_new);
 
-    MultiFab& S_new = get_new_data(State_Type);
-
-    FillPatch(old, S_new, 0, cur_time, State_Type, 0, NUM_STATE);
+    FillPatchFromOld(old, State_Type, cur_time);
 }
 
 //
@@ -14,6 +14,12 @@ class AdvBld
                                   const Geometry& level_geom,
                                   const BoxArray& ba,
                                   Real            time) BL_OVERRIDE;
+    virtual AmrLevel *operator() (Amr&                       papa,
+                                  int                        lev,
+                                  const Geometry&            level_geom,
+                                  const BoxArray&            ba,
+                                  const DistributionMapping& dm,
+                                  Real                       time) BL_OVERRIDE;
 };
 
 AdvBld Adv_bld;
@@ -51,3 +57,14 @@ AdvBld::operator() (Amr&            papa,
 {
     return new Adv(papa, lev, level_geom, ba, time);
 }
+
+AmrLevel*
+AdvBld::operator() (Amr&                       papa,
+		    int                        lev,
+		    const Geometry&            level_geom,
+		    const BoxArray&            ba,
+		    const DistributionMapping& dm,
+		    Real                       time)
+{
+    return new Adv(papa, lev, level_geom, ba, dm, time);
+}
@@ -105,8 +105,11 @@ Adv::advance (Real time,
 		current->FineAdd(fluxes[i],i,0,0,NUM_STATE,1.);
 	}
 	if (fine) {
+	    //
+	    // Finished by the fine level's first FineAdd().
+	    //
 	    for (int i = 0; i < BL_SPACEDIM ; i++)
-		fine->CrseInit(fluxes[i],i,0,0,NUM_STATE,-1.);
+		fine->CrseInit_nowait(fluxes[i],i,0,0,NUM_STATE,-1.);
 	}
     }
 